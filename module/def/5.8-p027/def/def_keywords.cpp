@@ -47,6 +47,8 @@
 #   include <direct.h>
 #else /* not WIN32 */
 #   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
 #endif /* WIN32 */
 
 
@@ -59,6 +61,24 @@ BEGIN_LEFDEF_PARSER_NAMESPACE
 
 int defrData::defGetKeyword(const char* name, int *result) 
 { 
+    unsigned len;
+    unsigned hash = defKeywordHash(name, &len);
+    unsigned slot = hash & (DEF_KEYWORD_HASH_SIZE - 1);
+
+    for (const defKeywordSlot* k = settings->Keyword_hash + slot; k->name;
+         k = settings->Keyword_hash + slot) {
+        if (k->hash == hash && k->len == len && !memcmp(k->name, name, len)) {
+            *result = k->value;
+            return TRUE;
+        }
+        slot = (slot + 1) & (DEF_KEYWORD_HASH_SIZE - 1);
+    }
+
+    // Entries added to Keyword_set after construction are not hashed.
+    if (settings->Keyword_hash_count == settings->Keyword_set.size()) {
+        return FALSE;
+    }
+
     map<const char*, int, defCompareCStrings>::const_iterator search = settings->Keyword_set.find(name);
 
     if ( search != settings->Keyword_set.end()) {
@@ -107,10 +127,69 @@ int defrData::defGetDefine(const string &name, string &result)
 #endif
 
 
+/* Maps the rest of a regular input file so GETC and DefGetToken work on
+ * it in place.  The mapping is private and writable only so UNGETC can
+ * keep its semantics; it writes nothing for the common case.
+ */
+int
+defrData::map_input()
+{
+#ifndef WIN32
+   struct stat st;
+   int         fd;
+   long long   pos;
+   void*       p;
+
+   if (settings->ReadFunction || File == NULL)
+      return FALSE;
+   fd = fileno(File);
+   if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+      return FALSE;
+   pos = ftello(File);
+   if (pos < 0 || pos >= (long long)st.st_size)
+      return FALSE;
+
+   p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+   if (p == MAP_FAILED)
+      return FALSE;
+#ifdef MADV_SEQUENTIAL
+   madvise(p, st.st_size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_HUGEPAGE
+   madvise(p, st.st_size, MADV_HUGEPAGE);
+#endif
+
+   map_begin = (char*)p;
+   map_size = st.st_size;
+   next = map_begin + pos;
+   last = map_begin + map_size - 1;
+   first_buffer = 0;
+   return TRUE;
+#else
+   return FALSE;
+#endif
+}
+
+void
+defrData::unmap_input()
+{
+#ifndef WIN32
+   if (map_begin)
+      munmap(map_begin, map_size);
+#endif
+   map_begin = NULL;
+   map_size = 0;
+}
+
 void 
 defrData::reload_buffer() {
    int nb = 0;
 
+   if (map_begin) {  /* the whole file is already in memory */
+      next = NULL;
+      return;
+   }
+
    if (first_buffer) {
       first_buffer = 0;
       if (settings->ReadFunction) {
@@ -160,10 +239,10 @@ int
 
 void 
 defrData::UNGETC(char ch) {
-    if (next <= buffer) {
+    if (next <= (map_begin ? map_begin : buffer)) {
         defError(6111, "UNGETC: buffer access violation.");
-    } else {
-        *(--next) = ch;
+    } else if (*(--next) != ch) {
+        *next = ch;
     }
 }
 
@@ -281,6 +360,66 @@ defrData::IncCurPos(char **curPos, char **buffer, int *bufferSize)
 }
 
 
+/* Scans a plain token straight out of the mapped input and copies it
+ * into *buf in one go.  Leaves next at the first character it did not
+ * handle and returns FALSE for quoted strings, newline tokens, the end
+ * of the input and anything else DefGetToken spells out char by char.
+ */
+int
+defrData::DefGetMappedToken(char **buf, int *bufferSize)
+{
+    char *p = next;
+    char *e;
+    int  invalid = 0;
+    int  len;
+    int  i;
+
+    /* skip blanks and count lines */
+    for (; p <= last; p++) {
+       if (*p == '\n') {
+          if (nl_token)
+             break;
+          print_lines(++nlines);
+       } else if (*p != ' ' && *p != '\t' && *p != '\r') {
+          break;
+       }
+    }
+    next = p;
+    if (p > last || *p == '\n' || *p == '"')
+       return FALSE;
+
+    for (e = p; e <= last; e++) {
+       if (*e == ' ' || *e == '\t' || *e == '\n' || *e == '\r')
+          break;
+       /* GETC would hand a 0xff byte back as EOF */
+       if ((unsigned char)*e == 0xff)
+          return FALSE;
+       if (*e & 0x80)
+          invalid = 1;
+    }
+    /* a '\r' only ends the token as part of a line end */
+    if (e < last && *e == '\r' && e[1] != '\n')
+       return FALSE;
+
+    len = e - p;
+    if (len >= *bufferSize) {
+       while (len >= *bufferSize)
+          *bufferSize *= 2;
+       *buf = (char*) realloc(*buf, *bufferSize);
+    }
+    if (names_case_sensitive) {
+       memcpy(*buf, p, len);
+    } else {
+       for (i = 0; i < len; i++)
+          (*buf)[i] = (p[i] >= 'a' && p[i] <= 'z')? (p[i] - 'a' + 'A') : p[i];
+    }
+    (*buf)[len] = '\0';
+    defInvalidChar = invalid;
+    next = e;
+    return TRUE;
+}
+
+
 int
 defrData::DefGetToken(char **buf, int *bufferSize)
 {
@@ -295,6 +434,9 @@ defrData::DefGetToken(char **buf, int *bufferSize)
           return TRUE;               /* if we get one, return it */
     }                                /* but if not, continue */
 
+    if (map_begin && next && DefGetMappedToken(buf, bufferSize))
+       return TRUE;
+
     /* skip blanks and count lines */
     while ((ch = GETC()) != EOF) {
        if (ch == '\n') {
@@ -32,7 +32,7 @@
 
 BEGIN_LEFDEF_PARSER_NAMESPACE
 
-extern defrContext defContext;
+extern thread_local defrContext defContext;
 
 class defAliasIterator {
 public:
@@ -181,7 +181,9 @@ defrData::defrData(const defrCallbacks *pCallbacks,
   deftoken((char*)malloc(TOKEN_SIZE)),
   uc_token((char*)malloc(TOKEN_SIZE)),
   pv_deftoken((char*)malloc(TOKEN_SIZE)),
-  File(0)
+  File(0),
+  map_begin(NULL),
+  map_size(0)
 {
     magic[0] = '\0';
     deftoken[0] = '\0';
@@ -214,6 +216,8 @@ defrData::defrData(const defrCallbacks *pCallbacks,
 defrData::~defrData()
 {
     // lex_un_init.
+    unmap_input();
+
     /* Close the file */
     if (defrLog) {
         fclose(defrLog);
@@ -501,6 +505,7 @@ init_call_func(0)
 {
 }
 
-defrContext defContext;
+// Each thread parses through its own settings, callbacks and session.
+thread_local defrContext defContext;
 
 END_LEFDEF_PARSER_NAMESPACE
@@ -81,6 +81,8 @@ public:
     inline int          defGetAlias(const std::string &name, std::string &result);
     inline int          defGetDefine(const std::string &name, std::string &result);
     void                reload_buffer(); 
+    int                 map_input();
+    void                unmap_input();
     int                 GETC();
 
     void                UNGETC(char ch);
@@ -89,6 +91,7 @@ public:
     inline void         print_lines(long long lines);
     const char *        lines2str(long long lines);
     static inline void  IncCurPos(char **curPos, char **buffer, int *bufferSize);
+    int                 DefGetMappedToken(char **buffer, int *bufferSize);
     int                 DefGetToken(char **buffer, int *bufferSize);
     static void         uc_array(char *source, char *dest);
     void                StoreAlias();
@@ -275,6 +278,8 @@ public:
     char                lineBuffer[MSG_SIZE];
 
     FILE* File;
+    char*  map_begin;  // the whole input file when it is mmap'ed
+    size_t map_size;
 };
 
 class defrContext {
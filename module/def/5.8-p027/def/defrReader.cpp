@@ -50,7 +50,7 @@
 
 BEGIN_LEFDEF_PARSER_NAMESPACE
 
-extern defrContext defContext;
+extern thread_local defrContext defContext;
 
 void
 def_init(const char  *func)
@@ -1252,6 +1252,9 @@ defrRead(FILE           *f,
 
     defData->session->FileName = (char*) fName;
     defData->File = f;
+    if (defData->settings->MmapInput) {
+        defData->map_input();
+    }
     defData->session->UserData = uData;
     defData->session->reader_case_sensitive = case_sensitive;
 
@@ -2497,6 +2500,20 @@ defrUnsetReadFunction()
     defContext.settings->ReadFunction = 0;
 }
 
+void
+defrSetMmapInput()
+{
+    DEF_INIT;
+    defContext.settings->MmapInput = 1;
+}
+
+void
+defrUnsetMmapInput()
+{
+    DEF_INIT;
+    defContext.settings->MmapInput = 0;
+}
+
 void
 defrDisablePropStrProcess()
 {
@@ -655,6 +655,12 @@ typedef size_t (*DEFI_READ_FUNCTION)  (FILE*, char*, size_t);
 extern void defrSetReadFunction(DEFI_READ_FUNCTION);
 extern void defrUnsetReadFunction ();
 
+// Routine to have defrRead map a regular input file into memory and
+// tokenize it in place instead of reading it through fread.  Ignored
+// when a read function is set.
+extern void defrSetMmapInput ();
+extern void defrUnsetMmapInput ();
+
 // Routine to set the defrWarning.log to open as append instead for write 
 // New in 5.7 
 extern void defrSetOpenLogFileAppend ();
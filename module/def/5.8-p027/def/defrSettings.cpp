@@ -67,6 +67,7 @@ defrSettings::defrSettings()
   AllowComponentNets(0),
   CommentChar('#'),
   DisPropStrProcess(0),
+  MmapInput(0),
   LogFileAppend(0),
   ReadFunction(NULL),
   ErrorLogFunction(NULL),
@@ -331,6 +332,30 @@ defrSettings::init_symbol_table()
     Keyword_set["X"] = K_X;
     Keyword_set["XTALK"] = K_XTALK;
     Keyword_set["Y"] = K_Y;
+
+    init_keyword_hash();
+}
+
+void
+defrSettings::init_keyword_hash()
+{
+    memset(Keyword_hash, 0, sizeof(Keyword_hash));
+    Keyword_hash_count = 0;
+
+    for (defKeywordMap::const_iterator it = Keyword_set.begin();
+         it != Keyword_set.end(); it++) {
+        unsigned len;
+        unsigned hash = defKeywordHash(it->first, &len);
+        unsigned slot = hash & (DEF_KEYWORD_HASH_SIZE - 1);
+        while (Keyword_hash[slot].name) {
+            slot = (slot + 1) & (DEF_KEYWORD_HASH_SIZE - 1);
+        }
+        Keyword_hash[slot].name = it->first;
+        Keyword_hash[slot].hash = hash;
+        Keyword_hash[slot].len = len;
+        Keyword_hash[slot].value = it->second;
+        Keyword_hash_count++;
+    }
 }
 
 defrSession::defrSession() 
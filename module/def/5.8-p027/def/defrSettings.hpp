@@ -49,14 +49,43 @@ struct defCompareCStrings
 
 typedef std::map<const char*, int, defCompareCStrings>  defKeywordMap;
 
+// Open-addressing hash over the keyword table.  Built once from Keyword_set
+// so the lexer resolves a token with one FNV-1a pass and usually one probe.
+#define DEF_KEYWORD_HASH_SIZE 1024
+
+struct defKeywordSlot
+{
+    const char*  name;
+    unsigned     hash;
+    unsigned     len;
+    int          value;
+};
+
+inline unsigned
+defKeywordHash(const char* name, unsigned *len)
+{
+    unsigned    h = 2166136261u;
+    const char* p = name;
+    for (; *p; p++) {
+        h ^= (unsigned char) *p;
+        h *= 16777619u;
+    }
+    *len = (unsigned) (p - name);
+    return h;
+}
+
 class defrSettings {
 public:
     defrSettings();
 
     void init_symbol_table();
+    void init_keyword_hash();
 
     defKeywordMap Keyword_set; 
 
+    defKeywordSlot Keyword_hash[DEF_KEYWORD_HASH_SIZE];
+    size_t         Keyword_hash_count;
+
     int defiDeltaNumberLines;
 
     ////////////////////////////////////
@@ -96,6 +125,7 @@ public:
     int AllowComponentNets;
     char CommentChar;
     int DisPropStrProcess; 
+    int MmapInput;
 
     int reader_case_sensitive_set;
 
@@ -49,6 +49,9 @@
 // 
 //   Highest message number = 4700
 
+// Pure, so the lookahead lives in lefyyparse and threads can parse at once
+%pure-parser
+
 %{
 #include <string.h>
 #include <stdlib.h>
@@ -43,6 +43,8 @@
 #   include <direct.h>
 #else // not WIN32 
 #   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
 #endif // WIN32
 
 #include "lefrData.hpp"
@@ -53,8 +55,6 @@ BEGIN_LEFDEF_PARSER_NAMESPACE
 
 #include "lef.tab.h"
 
-extern YYSTYPE lefyylval;
-
 
 inline string 
 strip_case(const char *str)
@@ -141,10 +141,7 @@ lefGetAlias(const char* name, const char** value)
 #define yyparse    lefyyparse
 #define yylex    lefyylex
 #define yyerror    lefyyerror
-#define yylval    lefyylval
-#define yychar    lefyychar
 #define yydebug    lefyydebug
-#define yynerrs    lefyynerrs
 
 // lef.cpph starts here.
 
@@ -162,6 +159,53 @@ extern char *lef_kywd(int num);
 // Varible from lex.cpph to keep track of invalid nonEnglish character 
 // in lef file 
 
+// Maps the rest of a regular input file so lefGetc and GetToken work on
+// it in place.  The mapping is private and writable only so UNlefGetc
+// keeps its semantics; it writes nothing for the common case.
+int
+lefMapInput()
+{
+#ifndef WIN32
+    struct stat st;
+    int         fd;
+    long long   pos;
+    void        *p;
+
+    if (lefSettings->ReadFunction || lefData->lefrFile == NULL)
+        return FALSE;
+    fd = fileno(lefData->lefrFile);
+    if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        return FALSE;
+    pos = ftello(lefData->lefrFile);
+    if (pos < 0 || pos + 4 > (long long) st.st_size)
+        return FALSE;
+
+    p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+        return FALSE;
+    // encrypted input goes through encFgetc 
+    if (encIsEncrypted((unsigned char*) p + pos)) {
+        munmap(p, st.st_size);
+        return FALSE;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_HUGEPAGE
+    madvise(p, st.st_size, MADV_HUGEPAGE);
+#endif
+
+    lefData->map_begin = (char*) p;
+    lefData->map_size = st.st_size;
+    lefData->next = lefData->map_begin + pos;
+    lefData->last = lefData->map_begin + lefData->map_size - 1;
+    lefData->first_buffer = 0;
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
 void
 lefReloadBuffer()
 {
@@ -169,6 +213,11 @@ lefReloadBuffer()
 
     nb = 0;
 
+    if (lefData->map_begin) {    // the whole file is already in memory 
+        lefData->next = NULL;
+        return;
+    }
+
     if (lefData->first_buffer) {
         lefData->first_buffer = 0;
         if (lefSettings->ReadFunction) {
@@ -245,10 +294,12 @@ lefGetc()
 void
 UNlefGetc(char ch)
 {
-    if ((lefData->next <= lefData->current_buffer) || (lefData->input_level > 0)) {
+    char *begin = lefData->map_begin ? lefData->map_begin : lefData->current_buffer;
+
+    if ((lefData->next <= begin) || (lefData->input_level > 0)) {
         lefError(1111, "UNlefGetc: buffer access violation.");
-    } else {
-        *(--lefData->next) = ch;
+    } else if (*(--lefData->next) != ch) {
+        *lefData->next = ch;
     }
 }
 
@@ -392,6 +443,66 @@ print_nlines(int lineNum)
 }
 
 
+// Scans a plain token straight out of the mapped input and copies it
+// into *buffer in one go.  Leaves lefData->next at the first character it
+// did not handle and returns FALSE for quoted strings, newline tokens,
+// the end of the input and anything else GetToken spells out char by char.
+static int
+GetMappedToken(char **buffer, int *bufferSize)
+{
+    char *p = lefData->next;
+    char *last = lefData->last;
+    char *e;
+    int  upper = !lefData->namesCaseSensitive && lefSettings->ShiftCase;
+    int  invalid = 0;
+    int  len;
+    int  i;
+
+    // skip blanks and count lines 
+    for (; p <= last; p++) {
+        if (*p == '\n') {
+            if (lefData->lefNlToken)
+                break;
+            print_nlines(++lefData->lef_nlines);
+        } else if (*p != ' ' && *p != '\t' && *p != '\r') {
+            break;
+        }
+    }
+    lefData->next = p;
+    if (p > last || *p == '\n' || *p == '"')
+        return FALSE;
+
+    for (e = p; e <= last; e++) {
+        if (*e == ' ' || *e == '\t' || *e == '\n' || *e == '\r')
+            break;
+        // lefGetc would hand a 0xff byte back as EOF 
+        if ((unsigned char) *e == 0xff)
+            return FALSE;
+        if (*e & 0x80)
+            invalid = 1;
+    }
+    // a '\r' only ends the token as part of a line end 
+    if (e < last && *e == '\r' && e[1] != '\n')
+        return FALSE;
+
+    len = e - p;
+    if (len >= *bufferSize) {
+        while (len >= *bufferSize)
+            *bufferSize *= 2;
+        *buffer = (char*) realloc(*buffer, *bufferSize);
+    }
+    if (upper) {
+        for (i = 0; i < len; i++)
+            (*buffer)[i] = (p[i] >= 'a' && p[i] <= 'z')? (p[i] - 'a' + 'A') : p[i];
+    } else {
+        memcpy(*buffer, p, len);
+    }
+    (*buffer)[len] = '\0';
+    lefData->lefInvalidChar = invalid;
+    lefData->next = e;
+    return TRUE;
+}
+
 static int
 GetToken(char **buffer, int *bufferSize)
 {
@@ -406,6 +517,10 @@ GetToken(char **buffer, int *bufferSize)
             return TRUE;                // if we get one, return it 
     }                                 // but if not, continue 
 
+    if (lefData->map_begin && lefData->next && lefData->input_level < 0 &&
+        GetMappedToken(buffer, bufferSize))
+        return TRUE;
+
     // skip blanks and count lines 
     while ((ch = lefGetc()) != EOF) {
         // check if the file is encrypted and user allows to read 
@@ -632,7 +747,7 @@ lefStoreAlias()
     free(uc_line);
 }
 
-int lefamper_lookup(char *token); // forward reference to this routine 
+int lefamper_lookup(YYSTYPE *pYylval, char *token); // forward reference to this routine 
 
 /* The main routine called by the YACC parser to get the lefData->next token.
  *    Returns 0 if no more tokens are available.
@@ -649,12 +764,12 @@ int lefamper_lookup(char *token); // forward reference to this routine
  * Newlines are in general silently ignored.  If the global lefData->lefNlToken is
  * true, however, they are returned as the token K_NL.
  */
-extern int lefsublex();
+extern int lefsublex(YYSTYPE *pYylval);
 
 int
-yylex()
+yylex(YYSTYPE *pYylval)
 {
-    int v = lefsublex();
+    int v = lefsublex(pYylval);
 
     if (lefData->lefDebug[13]) {
         if (v == 0) {
@@ -662,11 +777,11 @@ yylex()
         } else if (v < 256) {
             printf("yylex char %c\n", v);
         } else if (v == QSTRING) {
-            printf("yylex quoted string '%s'\n", yylval.string);
+            printf("yylex quoted string '%s'\n", pYylval->string);
         } else if (v == T_STRING) {
-            printf("yylex string '%s'\n", yylval.string);
+            printf("yylex string '%s'\n", pYylval->string);
         } else if (v == NUMBER) {
-            printf("yylex number %f\n", yylval.dval);
+            printf("yylex number %f\n", pYylval->dval);
         } else {
             printf("yylex keyword %s\n", lef_kywd(v));
         }
@@ -686,7 +801,7 @@ yylex()
 }
 
 int
-lefsublex()
+lefsublex(YYSTYPE *pYylval)
 {
 
     char    fc;
@@ -769,7 +884,7 @@ lefsublex()
     }
 
     if (fc == '\"') {
-        yylval.string = ringCopy(&(lefData->current_token[1]));
+        pYylval->string = ringCopy(&(lefData->current_token[1]));
         return QSTRING;
     }
 
@@ -779,11 +894,11 @@ lefsublex()
     lefData->lefNoNum--;
     if (isdigit(fc) || fc == '.' || (fc == '-' && lefData->current_token[1] != '\0')) {
         char *ch;
-        numVal = yylval.dval = strtod(lefData->current_token, &ch);
+        numVal = pYylval->dval = strtod(lefData->current_token, &ch);
         if (lefData->lefNoNum < 0 && *ch == '\0') {    // did we use the whole string? 
                 return NUMBER;
         } else {  // failed integer conversion, try floating point 
-                yylval.string = ringCopy(lefData->current_token);  // NO, it's a string 
+                pYylval->string = ringCopy(lefData->current_token);  // NO, it's a string 
                 return T_STRING;
             }
         }
@@ -791,7 +906,7 @@ lefsublex()
     // 5/17/2004 - Special checking for nondefaultrule 
     if (lefData->lefNdRule && (strcmp(lefData->current_token, "END") != 0)) {
         if (strcmp(lefData->current_token, lefData->ndName) == 0) {
-            yylval.string = ringCopy(lefData->current_token);  // a nd rule name 
+            pYylval->string = ringCopy(lefData->current_token);  // a nd rule name 
             return T_STRING;
         } else {
             // Can be NONDEFAULTRULE END without name, this case, string 
@@ -811,7 +926,7 @@ lefsublex()
         if (lefData->lefNewIsKeyword && strcmp(lefData->current_token, "NEW") == 0) {
             return K_NEW; // even in dumb mode, we must see the NEW token 
         }
-        yylval.string = ringCopy(lefData->current_token);
+        pYylval->string = ringCopy(lefData->current_token);
         // 5/17/2004 - Special checking for nondefaultrule 
         if (lefData->lefNdRule) {
             if (strcmp(lefData->current_token, lefData->ndName) == 0)
@@ -932,8 +1047,8 @@ lefsublex()
             return result;        // YES, return its value 
         } else {  // we don't have a keyword.  
             if (fc == '&')
-                return lefamper_lookup(lefData->current_token);
-            yylval.string = ringCopy(lefData->current_token);  // NO, it's a string 
+                return lefamper_lookup(pYylval, lefData->current_token);
+            pYylval->string = ringCopy(lefData->current_token);  // NO, it's a string 
             return T_STRING;
         }
     } else {  // it should be a punctuation character 
@@ -951,7 +1066,7 @@ lefsublex()
                 // strcpy(saved_token, &token[1]); // the standard syntax, but 
                 // stack[++lefData->input_level] = saved_token; // C3 and GE support. 
             } else if (lefData->current_token[0] == '_') {// name starts with _, return as T_STRING 
-                yylval.string = ringCopy(lefData->current_token);
+                pYylval->string = ringCopy(lefData->current_token);
                 return T_STRING;
             } else {
                 lefError(6016, "Odd punctuation found.");
@@ -971,7 +1086,7 @@ lefsublex()
 /* We have found a token beginning with '&'.  If it has been previously
    defined, substitute the definition.  Otherwise return it. */
 int
-lefamper_lookup(char *tkn)
+lefamper_lookup(YYSTYPE *pYylval, char *tkn)
 {
     double        dptr;
     int           result;
@@ -981,7 +1096,7 @@ lefamper_lookup(char *tkn)
 
     // &define returns a number 
     if (lefGetDoubleDefine(tkn, &dptr)) {
-        yylval.dval = dptr;
+        pYylval->dval = dptr;
         return NUMBER;
     }
     // &defineb returns TRUE or FALSE, encoded as K_TRUE or K_FALSE 
@@ -991,11 +1106,11 @@ lefamper_lookup(char *tkn)
     if (lefGetStringDefine(tkn, &cptr)) {
         if (lefGetKeyword(cptr, &result))
             return result;
-        yylval.string = ringCopy(cptr);
+        pYylval->string = ringCopy(cptr);
         return (cptr[0] == '\"' ? QSTRING : T_STRING);
     }
     // if none of the above, just return the token. 
-    yylval.string = ringCopy(tkn);
+    pYylval->string = ringCopy(tkn);
     return T_STRING;
 }
 
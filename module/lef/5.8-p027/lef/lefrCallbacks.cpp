@@ -94,7 +94,7 @@ lefrCallbacks::lefrCallbacks()
 {
 }
 
-lefrCallbacks *lefCallbacks = NULL;
+thread_local lefrCallbacks *lefCallbacks = NULL;
 
 void
 lefrCallbacks::reset()
@@ -27,6 +27,9 @@
 // *****************************************************************************
 // *****************************************************************************
 #include <sys/stat.h>
+#ifndef WIN32
+#   include <sys/mman.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
@@ -40,7 +43,8 @@ BEGIN_LEFDEF_PARSER_NAMESPACE
 
 extern void *lefMalloc(size_t lef_size);
 
-lefrData  *lefData = NULL;
+// Each thread parses through its own data, settings and callbacks.
+thread_local lefrData  *lefData = NULL;
 
 lefrData::lefrData()
 : antennaInoutWarnings(0),
@@ -227,7 +231,9 @@ lefrData::lefrData()
   current_token((char*) malloc(TOKEN_SIZE)),
   pv_token((char*) malloc(TOKEN_SIZE)),
   uc_token((char*) malloc(TOKEN_SIZE)), 
-  tokenSize(TOKEN_SIZE)
+  tokenSize(TOKEN_SIZE),
+  map_begin(NULL),
+  map_size(0)
 {
     Hist_text.push_back('\0');
 
@@ -293,6 +299,12 @@ lefrData::lefrData()
 lefrData::~lefrData()
 {
     //lef_lex_un_init()
+#ifndef WIN32
+    if (map_begin) {
+        munmap(map_begin, map_size);
+    }
+#endif
+
     /* Close the file */
     if (lefrLog) {
         fclose(lefrLog);
@@ -286,6 +286,8 @@ public:
     char       *uc_token; 
 
     char       current_buffer[IN_BUF_SIZE];
+    char       *map_begin;  // the whole input file when it is mmap'ed
+    size_t      map_size;
     const char *current_stack[20];  // the stack itself 
 
     char       lefrErrMsg[1024];
@@ -299,7 +301,7 @@ public:
     int msgLimit[2][MAX_LEF_MSGS];
 };
 
-extern lefrData *lefData;
+extern thread_local lefrData *lefData;
 
 END_LEFDEF_PARSER_NAMESPACE
 
@@ -43,7 +43,7 @@
 
 BEGIN_LEFDEF_PARSER_NAMESPACE
 
-static const char *init_call_func = NULL;
+static thread_local const char *init_call_func = NULL;
 
 extern double convert_name2num(const char *versionName);
 extern bool validateMaskNumber(int num);
@@ -315,6 +315,9 @@ lefrRead(FILE           *f,
 
     lefData->lefrFileName = (char*) fName;
     lefData->lefrFile = f;
+    if (lefSettings->MmapInput) {
+        lefMapInput();
+    }
     lefSettings->UserData = uData;
 
     status = lefyyparse();
@@ -463,7 +466,7 @@ lefrSetUnusedCallbacks(lefrVoidCbkFnType func)
 }
 
 // These count up the number of times an unset callback is called... 
-static int lefrUnusedCount[NOCBK];
+static thread_local int lefrUnusedCount[NOCBK];
 
 int
 lefrCountFunc(lefrCallbackType_e    e,
@@ -1661,6 +1664,20 @@ lefrUnsetOpenLogFileAppend()
     lefSettings->LogFileAppend = FALSE;
 }
 
+void
+lefrSetMmapInput()
+{
+    LEF_INIT;
+    lefSettings->MmapInput = TRUE;
+}
+
+void
+lefrUnsetMmapInput()
+{
+    LEF_INIT;
+    lefSettings->MmapInput = FALSE;
+}
+
 void
 lefrSetReadFunction(LEFI_READ_FUNCTION f)
 {
@@ -519,6 +519,12 @@ typedef size_t (*LEFI_READ_FUNCTION) (FILE*, char*, size_t);
 extern void lefrSetReadFunction(LEFI_READ_FUNCTION);
 extern void lefrUnsetReadFunction();
 
+// Routine to have lefrRead map a regular, unencrypted input file into
+// memory and tokenize it in place instead of reading it through fread.
+// Ignored when a read function is set.
+extern void lefrSetMmapInput();
+extern void lefrUnsetMmapInput();
+
 // Routine to set the lefrWarning.log to open as append instead for write 
 // New in 5.7 
 extern void lefrSetOpenLogFileAppend();
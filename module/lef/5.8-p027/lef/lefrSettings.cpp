@@ -35,7 +35,7 @@
 
 BEGIN_LEFDEF_PARSER_NAMESPACE
 
-lefrSettings *lefSettings = NULL;
+thread_local lefrSettings *lefSettings = NULL;
 
 lefrSettings::lefrSettings()
 : DisPropStrProcess(0),
@@ -86,6 +86,7 @@ lefrSettings::lefrSettings()
   ViaRuleWarnings(999),
   ViaWarnings(999),
   LogFileAppend(0),
+  MmapInput(0),
   SetLogFunction(0),
   TotalMsgLimit(0),
   WarningLogFunction(0),
@@ -127,6 +127,7 @@ public:
     int ViaRuleWarnings;
     int ViaWarnings;
     int LogFileAppend;
+    int MmapInput;
     int TotalMsgLimit;
     lefiUserData UserData;
 
@@ -147,7 +148,7 @@ public:
     lefrProps lefProps;
 };
 
-extern lefrSettings* lefSettings;
+extern thread_local lefrSettings* lefSettings;
 
 END_LEFDEF_PARSER_NAMESPACE
 
@@ -57,13 +57,17 @@ void lefFree(void *name);
 void lefSetNonDefault(const char *name);
 void lefUnsetNonDefault();
 
-extern int yylex();
+union YYSTYPE;
+
+extern int yylex(YYSTYPE *pYylval);
 extern void lex_init();
 extern int lefyyparse();
 extern void lex_un_init();
 
 int fake_ftell();
 
+int lefMapInput();
+
 END_LEFDEF_PARSER_NAMESPACE
 
 #endif
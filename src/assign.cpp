@@ -51,6 +51,7 @@ using std::pair;
 using std::cout;
 using std::endl;
 using std::cerr;
+using std::vector;
 
 // Fixed cell handle on parser ( no need to use this function during placement)
 // //
@@ -76,7 +77,7 @@ void circuit::fixed_cell_assign() {
       x_end = min(x_end, x_end_rf);
 
 #ifdef DEBUG
-      cout << " cell_name : " << theCell->name << endl;
+      cout << " cell_name : " << cell_name(theCell) << endl;
       cout << " y_start : " << y_start << endl;
       cout << " y_end   : " << y_end << endl;
       cout << " x_start : " << x_start << endl;
@@ -84,8 +85,7 @@ void circuit::fixed_cell_assign() {
 #endif
       for(int j = y_start; j < y_end; j++) {
         for(int k = x_start; k < x_end; k++) {
-          grid[j][k].linked_cell = theCell;
-          grid[j][k].util = 1.0;
+          grid.linked_cell[grid.index(j, k)] = theCell->id;
         }
       }
     }
@@ -98,14 +98,14 @@ void circuit::print_pixels() {
 
   for(int i = 0; i < rows.size(); i++) {
     for(int j = 0; j < rows[i].numSites; j++) {
-      // cout << grid[i][j].util << " ";
-      if(grid[i][j].util > 0.00001) {
-        cout << grid[i][j].util << " ";
-        if(grid[i][j].group == UINT_MAX) {
+      unsigned groupId = grid.group_at(i, j);
+      if(grid.cell_at(i, j) != PIXEL_EMPTY || groupId != UINT_MAX) {
+        cout << pixel(j, i).name() << " ";
+        if(groupId == UINT_MAX) {
           cout << " no_group ";
         }
         else {
-          cout << groups[grid[i][j].group].name << " ";
+          cout << groups[groupId].name << " ";
         }
       }
     }
@@ -123,9 +123,9 @@ void circuit::group_cell_region_assign() {
     double area = 0;
     for(int j = 0; j < rows.size(); j++) {
       for(int k = 0; k < rows[j].numSites; k++) {
-        if(grid[j][k].group != UINT_MAX) {
-          if(grid[j][k].isValid == true) {
-            if(groups[grid[j][k].group].name == theGroup->name)
+        if(grid.group_at(j, k) != UINT_MAX) {
+          if(grid.valid_at(j, k) == true) {
+            if(groups[grid.group_at(j, k)].name == theGroup->name)
               area += wsite * rowHeight;
           }
         }
@@ -135,23 +135,24 @@ void circuit::group_cell_region_assign() {
     double cell_area = 0;
     for(int j = 0; j < theGroup->siblings.size(); j++) {
       cell* theCell = theGroup->siblings[j];
+      cell_info* theInfo = &cell_infos[theCell->id];
       cell_area += theCell->width * theCell->height;
       int dist = INT_MAX;
       unsigned region_backup = UINT_MAX;
       for(int k = 0; k < theGroup->regions.size(); k++) {
         rect* theRect = &theGroup->regions[k];
-        if(check_inside(theCell, theRect, "init_coord") == true)
-          theCell->region = k;
-        int temp_dist = dist_for_rect(theCell, theRect, "init_coord");
+        if(check_inside(theCell, theRect, MODE_INIT_COORD) == true)
+          theInfo->region = k;
+        int temp_dist = dist_for_rect(theCell, theRect, MODE_INIT_COORD);
         if(temp_dist < dist) {
           dist = temp_dist;
           region_backup = k;
         }
       }
-      if(theCell->region == UINT_MAX) {
-        theCell->region = region_backup;
+      if(theInfo->region == UINT_MAX) {
+        theInfo->region = region_backup;
       }
-      assert(theCell->region != UINT_MAX);
+      assert(theInfo->region != UINT_MAX);
     }
     theGroup->util = cell_area / area;
   }
@@ -258,17 +259,17 @@ void circuit::y_align() {
 void circuit::cell_y_align(cell* theCell) {
   int cell_y_size = (int)ceil(theCell->height / rowHeight);
   macro* theMacro = &macros[theCell->type];
-  pair< bool, pixel* > myPixel =
+  pair< bool, pixel > myPixel =
       diamond_search(theCell, theCell->init_x_coord, theCell->init_y_coord);
-  theCell->y_pos = myPixel.second->y_pos;
+  theCell->y_pos = myPixel.second.y_pos;
   // top power align --> cell orient ( flip )
   if( max_cell_height > 1 ) {
     if(cell_y_size % 2 == 1 &&
-        rows[myPixel.second->y_pos].top_power != theMacro->top_power)
-      theCell->cellorient = "FS";
+        rows[myPixel.second.y_pos].top_power != theMacro->top_power)
+      theCell->cellorient = ORIENT_FS;
   }
   else {
-    theCell->cellorient = rows[myPixel.second->y_pos].siteorient;
+    theCell->cellorient = rows[myPixel.second.y_pos].siteorient;
   }
 
   return;
@@ -292,9 +293,8 @@ void circuit::group_pixel_assign_2() {
           // cout << "grid[" << i << "][" << j << "]";
           if(check_inside(theGrid, theGroup->regions[l]) == false &&
              check_overlap(theGrid, theGroup->regions[l]) == true) {
-            grid[i][j].util = 0.0;
-            grid[i][j].linked_cell = &dummy_cell;
-            grid[i][j].isValid = false;
+            grid.linked_cell[grid.index(i, j)] = PIXEL_DUMMY;
+            grid.isValid[grid.index(i, j)] = false;
             // cout << "invalid grid[" << i << "][" << j << "] marked" << endl;
           }
         }
@@ -305,12 +305,10 @@ void circuit::group_pixel_assign_2() {
 }
 
 void circuit::group_pixel_assign() {
-  for(int i = 0; i < rows.size(); i++) {
-    row* theRow = &rows[i];
-    for(int j = 0; j < theRow->numSites; j++) {
-      grid[i][j].util = 0.0;
-    }
-  }
+  if(groups.size() == 0) return;
+
+  // region coverage of each site ( only needed while assigning groups )
+  vector< double > util(grid.linked_cell.size(), 0.0);
 
   for(int i = 0; i < groups.size(); i++) {
     group* theGroup = &groups[i];
@@ -327,15 +325,15 @@ void circuit::group_pixel_assign() {
         int col_end = (int)ceil(theRect->xUR / (double)theRow->stepX);
 
         for(int l = col_start; l < col_end; l++) {
-          grid[k][l].util += 1.0;
+          util[grid.index(k, l)] += 1.0;
         }
         if((int)(theRect->xLL + 0.5) % theRow->stepX != 0) {
-          grid[k][col_start].util -=
+          util[grid.index(k, col_start)] -=
               ((int)(theRect->xLL + 0.5) % theRow->stepX) /
               (double)theRow->stepX;
         }
         if((int)(theRect->xUR + 0.5) % theRow->stepX != 0) {
-          grid[k][col_end - 1].util -=
+          util[grid.index(k, col_end - 1)] -=
               (200 - (int)(theRect->xUR + 0.5) % theRow->stepX) /
               (double)theRow->stepX;
         }
@@ -351,20 +349,21 @@ void circuit::group_pixel_assign() {
         int col_end = (int)ceil(theRect->xUR / (double)theRow->stepX);
         // assig groupid to each pixel ( grid )
         for(int l = col_start; l < col_end; l++) {
-          if(abs(grid[k][l].util - 1.0) < 1e-6) {
-            grid[k][l].group = group2id[theGroup->name];
-            grid[k][l].linked_cell = NULL;
-            grid[k][l].isValid = true;
-            grid[k][l].util = 1.0;
+          size_t idx = grid.index(k, l);
+          if(abs(util[idx] - 1.0) < 1e-6) {
+            grid.group[idx] = group2id[theGroup->name];
+            grid.linked_cell[idx] = PIXEL_EMPTY;
+            grid.isValid[idx] = true;
+            util[idx] = 1.0;
           }
-          else if(grid[k][l].util > 0 && grid[k][l].util < 1) {
+          else if(util[idx] > 0 && util[idx] < 1) {
 #ifdef DEBUG2
-            cout << "grid[" << k << "][" << l << "]" << endl;
-            cout << "util : " << grid[k][l].util << endl;
+            cout << pixel(l, k).name() << endl;
+            cout << "util : " << util[idx] << endl;
 #endif
-            grid[k][l].linked_cell = &dummy_cell;
-            grid[k][l].util = 0.0;
-            grid[k][l].isValid = false;
+            grid.linked_cell[idx] = PIXEL_DUMMY;
+            util[idx] = 0.0;
+            grid.isValid[idx] = false;
           }
         }
       }
@@ -379,21 +378,27 @@ void circuit::erase_pixel(cell* theCell) {
   int x_step = (int)ceil(theCell->width / wsite);
   int y_step = (int)ceil(theCell->height / rowHeight);
 
+  if(undo_depth > 0) {
+    pixel_change change;
+    change.cell = theCell->id;
+    change.painted = false;
+    change.x_pos = theCell->x_pos;
+    change.y_pos = theCell->y_pos;
+    change.hold = theCell->hold;
+    undo_log.push_back(change);
+  }
+
   theCell->isPlaced = false;
   theCell->hold = false;
 
   assert(theCell->x_pos == (int)floor(theCell->x_coord / wsite + 0.5));
   assert(theCell->y_pos == (int)floor(theCell->y_coord / rowHeight + 0.5));
-  for(int i = theCell->y_pos; i < theCell->y_pos + y_step; i++) {
-    for(int j = theCell->x_pos; j < theCell->x_pos + x_step; j++) {
-      grid[i][j].linked_cell = NULL;
-      grid[i][j].util = 0;
-    }
-  }
+  grid.erase(theCell->y_pos, theCell->x_pos, x_step, y_step);
   theCell->x_coord = 0;
   theCell->y_coord = 0;
   theCell->x_pos = 0;
   theCell->y_pos = 0;
+  track_move(theCell);
   return;
 }
 
@@ -403,13 +408,24 @@ bool circuit::paint_pixel(cell* theCell, int x_pos, int y_pos) {
   int x_step = (int)ceil(theCell->width / wsite);
   int y_step = (int)ceil(theCell->height / rowHeight);
 
+  if(undo_depth > 0) {
+    pixel_change change;
+    change.cell = theCell->id;
+    change.painted = true;
+    change.x_pos = x_pos;
+    change.y_pos = y_pos;
+    change.hold = false;
+    undo_log.push_back(change);
+  }
+
   theCell->x_pos = x_pos;
   theCell->y_pos = y_pos;
   theCell->x_coord = x_pos * wsite;
   theCell->y_coord = y_pos * rowHeight;
   theCell->isPlaced = true;
+  track_move(theCell);
 #ifdef DEBUG
-  cout << "paint cell : " << theCell->name << endl;
+  cout << "paint cell : " << cell_name(theCell) << endl;
   cout << "group : " << theCell->group << endl;
   cout << "init_x_coord - init_y_coord : " << theCell->init_x_coord << " - "
        << theCell->init_y_coord << endl;
@@ -420,27 +436,26 @@ bool circuit::paint_pixel(cell* theCell, int x_pos, int y_pos) {
 #endif
   for(int i = y_pos; i < y_pos + y_step; i++) {
     for(int j = x_pos; j < x_pos + x_step; j++) {
-      if(grid[i][j].linked_cell != NULL) {
-        cerr << " Can't paint grid [" << i << "][" << j << "] !!!" << endl;
-        cerr << " group name : " << groups[grid[i][j].group].name << endl;
-        cerr << " Cell name : " << grid[i][j].linked_cell->name
+      size_t idx = grid.index(i, j);
+      if(grid.linked_cell[idx] != PIXEL_EMPTY) {
+        cerr << " Can't paint " << pixel(j, i).name() << " !!!" << endl;
+        if(grid.group_at(i, j) != UINT_MAX)
+          cerr << " group name : " << groups[grid.group_at(i, j)].name << endl;
+        cerr << " Cell name : " << cell_name(pixel_cell(i, j))
              << " already occupied grid" << endl;
         exit(2);
         return false;
       }
-      else {
-        grid[i][j].linked_cell = theCell;
-        grid[i][j].util = 1.0;
-      }
     }
   }
+  grid.paint(y_pos, x_pos, x_step, y_step, theCell->id);
 
   if( max_cell_height > 1) {
     if(  y_step % 2 == 1) {
       if(rows[y_pos].top_power != theMacro->top_power)
-        theCell->cellorient = "FS";
+        theCell->cellorient = ORIENT_FS;
       else
-        theCell->cellorient = "N";
+        theCell->cellorient = ORIENT_N;
     }
   }
   else {
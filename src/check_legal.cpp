@@ -43,6 +43,8 @@ using opendp::cell;
 using opendp::row;
 using opendp::pixel;
 using opendp::rect;
+using opendp::macro;
+using opendp::violation;
 
 using std::max;
 using std::min;
@@ -55,17 +57,72 @@ using std::vector;
 using std::make_pair;
 using std::to_string;
 
+static const char* check_names[] = {"row_check",    "site_check",
+                                    "power_check",  "edge_check",
+                                    "placed_check", "overlap_check",
+                                    "bound_check"};
+
 bool circuit::check_legality() {
+  vector< violation > violations = legality_violations();
+
   ofstream log("../logdir/check_legality.log");
+  int count[NUM_VIOLATION_TYPES] = {0};
+  for(int i = 0; i < violations.size(); i++) {
+    violation* theViolation = &violations[i];
+    cell* theCell = &cells[theViolation->cell];
+    count[theViolation->type]++;
+
+    log << " " << check_names[theViolation->type] << " fail ==> "
+        << cell_name(theCell);
+    switch(theViolation->type) {
+      case ROW_VIOLATION:
+        log << "  y_coord : " << theCell->y_coord;
+        break;
+      case SITE_VIOLATION:
+        log << "  x_coord : " << theCell->x_coord;
+        break;
+      case EDGE_VIOLATION:
+        log << " >> " << theViolation->value << "(" << theViolation->limit
+            << ") << " << cell_infos[theViolation->other].name;
+        break;
+      case POWER_VIOLATION:
+        if(theViolation->limit < 0)
+          log << " ( even height )";
+        else
+          log << " ( Should be "
+              << orient_name(static_cast< opendp::orient >(theViolation->limit))
+              << " )";
+        break;
+      case OVERLAP_VIOLATION:
+        log << " overlaps " << cell_infos[theViolation->other].name;
+        break;
+      default:
+        break;
+    }
+    log << " ( " << IntConvert(theViolation->x_pos * wsite + core.xLL) << ", "
+        << IntConvert(theViolation->y_pos * rowHeight + core.yLL) << " )"
+        << endl;
+  }
+
   cout << " ==== CHECK LEGALITY ==== " << endl;
+  for(int i = 0; i < NUM_VIOLATION_TYPES; i++) {
+    if(count[i] > 0)
+      cout << " " << check_names[i] << " ==>> FAIL (" << count[i] << ")"
+           << endl;
+    else
+      cout << " " << check_names[i] << " ==>> PASS " << endl;
+  }
+  return violations.empty();
+}
 
-  row_check(log);
-  site_check(log);
-  power_line_check(log);
-  edge_check(log);
-  placed_check(log);
-  overlap_check(log);
-  return false;
+vector< violation > circuit::legality_violations() {
+  vector< violation > violations;
+  row_check(violations);
+  site_check(violations);
+  power_line_check(violations);
+  placed_check(violations);
+  overlap_check(violations);
+  return violations;
 }
 
 void circuit::local_density_check(double unit, double target_Ut) {
@@ -260,113 +317,33 @@ void circuit::local_density_check(double unit, double target_Ut) {
   return;
 }
 
-void circuit::row_check(ofstream& log) {
-  bool valid = true;
-  int count = 0;
+void circuit::row_check(vector< violation >& violations) {
   for(int i = 0; i < cells.size(); i++) {
     cell* theCell = &cells[i];
     if(theCell->isFixed == true) continue;
     if((int)theCell->y_coord % (int)rowHeight != 0) {
-      log << " row_check fail ==> " << theCell->name
-          << "  y_coord : " << theCell->y_coord << endl;
-      valid = false;
-      count++;
+      violations.push_back(violation(ROW_VIOLATION, theCell->id,
+                                     theCell->x_coord / wsite,
+                                     theCell->y_coord / rowHeight));
     }
   }
-
-  if(valid == false)
-    cout << " row_check ==>> FAIL (" << count << ")" << endl;
-  else
-    cout << " row_check ==>> PASS " << endl;
-
   return;
 }
 
-void circuit::site_check(ofstream& log) {
-  bool valid = true;
-  int count = 0;
+void circuit::site_check(vector< violation >& violations) {
   for(int i = 0; i < cells.size(); i++) {
     cell* theCell = &cells[i];
     if(theCell->isFixed == true) continue;
     if((int)theCell->x_coord % (int)wsite != 0) {
-      log << " site_check fail ==> " << theCell->name
-          << "  x_coord : " << theCell->x_coord << endl;
-      valid = false;
-      count++;
-    }
-  }
-  if(valid == false)
-    cout << " site_check ==>> FAIL (" << count << ")" << endl;
-  else
-    cout << " site_check ==>> PASS " << endl;
-  return;
-}
-
-void circuit::edge_check(ofstream& log) {
-  bool valid = true;
-  int count = 0;
-
-  for(int i = 0; i < rows.size(); i++) {
-    vector< cell* > cell_list;
-    assert(cell_list.size() == 0);
-    for(int j = 0; j < rows[i].numSites; j++) {
-      cell* grid_cell = grid[i][j].linked_cell;
-      if(grid[i][j].isValid == false) continue;
-      if(grid_cell != NULL && grid_cell->name != "FIXED_DUMMY") {
-#ifdef DEBUG
-        cout << "grid util : " << grid[i][j].util << endl;
-        cout << "cell name : " << grid[i][j].linked_cell->name << endl;
-#endif
-        if(cell_list.size() == 0) {
-          cell_list.push_back(grid[i][j].linked_cell);
-        }
-        else if(cell_list[cell_list.size() - 1] != grid[i][j].linked_cell) {
-          cell_list.push_back(grid[i][j].linked_cell);
-        }
-      }
-    }
-#ifdef DEBUG
-    cout << " row search done " << endl;
-    cout << " cell list size : " << cell_list.size() << endl;
-#endif
-    if(cell_list.size() < 1) continue;
-
-    for(int k = 0; k < cell_list.size() - 1; k++) {
-#ifdef DEBUG
-      cout << " left cell : " << cell_list[k]->name << endl;
-      cout << " Right cell : " << cell_list[k + 1]->name << endl;
-#endif
-      if(cell_list.size() < 2) continue;
-      macro* left_macro = &macros[cell_list[k]->type];
-      macro* right_macro = &macros[cell_list[k + 1]->type];
-      if(left_macro->edgetypeRight == 0 || right_macro->edgetypeLeft == 0)
-        continue;
-      int space =
-          (int)floor(edge_spacing[make_pair(left_macro->edgetypeRight,
-                                            right_macro->edgetypeLeft)] /
-                         wsite +
-                     0.5);
-      int cell_dist = cell_list[k + 1]->x_coord - cell_list[k]->x_coord -
-                      cell_list[k]->width;
-      if(cell_dist < space) {
-        log << " edge_check fail ==> " << cell_list[k]->name << " >> "
-            << cell_dist << "(" << space << ") << " << cell_list[k + 1]->name
-            << endl;
-        count++;
-      }
+      violations.push_back(violation(SITE_VIOLATION, theCell->id,
+                                     theCell->x_coord / wsite,
+                                     theCell->y_coord / rowHeight));
     }
   }
-
-  if(valid == false)
-    cout << " edge_check ==>> FAIL (" << count << ")" << endl;
-  else
-    cout << " edge_check ==>> PASS " << endl;
   return;
 }
 
-void circuit::power_line_check(ofstream& log) {
-  bool valid = true;
-  int count = 0;
+void circuit::power_line_check(vector< violation >& violations) {
   for(int i = 0; i < cells.size(); i++) {
     cell* theCell = &cells[i];
     if(theCell->isFixed == true) continue;
@@ -379,135 +356,131 @@ void circuit::power_line_check(ofstream& log) {
 
     macro* theMacro = &macros[theCell->type];
     int y_size = (int)floor(theCell->height / rowHeight + 0.5);
+    int x_pos = (int)floor(theCell->x_coord / wsite + 0.5);
     int y_pos = (int)floor(theCell->y_coord / rowHeight + 0.5);
+
+    // limit : expected orient, -1 if the row itself is wrong
+    int expected = theCell->cellorient;
     if(y_size % 2 == 0) {
-      if(theMacro->top_power == rows[y_pos].top_power) {
-        log << " power_check fail ( even height ) ==> " << theCell->name
-            << endl;
-        valid = false;
-        count++;
-      }
+      if(theMacro->top_power == rows[y_pos].top_power) expected = -1;
     }
-    else {
-      if(theMacro->top_power == rows[y_pos].top_power) {
-        if(theCell->cellorient != "N") {
-          log << " power_check fail ( Should be N ) ==> " << theCell->name
-              << endl;
-          valid = false;
-          count++;
-        }
-      }
-      else {
-        if(theCell->cellorient != "FS") {
-          log << " power_check fail ( Should be FS ) ==> " << theCell->name
-              << endl;
-          valid = false;
-          count++;
-        }
-      }
+    else if(theMacro->top_power == rows[y_pos].top_power)
+      expected = ORIENT_N;
+    else
+      expected = ORIENT_FS;
+
+    if(expected != theCell->cellorient) {
+      violation theViolation(POWER_VIOLATION, theCell->id, x_pos, y_pos);
+      theViolation.value = theCell->cellorient;
+      theViolation.limit = expected;
+      violations.push_back(theViolation);
     }
   }
-
-  if(valid == false)
-    cout << " power_check ==>> FAIL (" << count << ")" << endl;
-  else
-    cout << " power_check ==>> PASS " << endl;
   return;
 }
 
-void circuit::placed_check(ofstream& log) {
-  bool valid = true;
-  int count = 0;
+void circuit::placed_check(vector< violation >& violations) {
   for(int i = 0; i < cells.size(); i++) {
     cell* theCell = &cells[i];
     if(theCell->isPlaced == false) {
-      log << " placed_check fail ==> " << theCell->name << endl;
-      valid = false;
-      count++;
+      violations.push_back(violation(PLACED_VIOLATION, theCell->id,
+                                     theCell->x_coord / wsite,
+                                     theCell->y_coord / rowHeight));
     }
   }
-
-  if(valid == false)
-    cout << " placed_check ==>> FAIL (" << count << ")" << endl;
-  else
-    cout << " placed_check ==>> PASS " << endl;
-
   return;
 }
 
-void circuit::overlap_check(ofstream& log) {
-  bool valid = true;
-  int row = rows.size();
-  pixel** grid_2;
-  grid_2 = new pixel*[row];
-  for(int i = 0; i < row; i++) {
-    int col = rows[i].numSites;
-    grid_2[i] = new pixel[col];
-  }
-
-  for(int i = 0; i < row; i++) {
-    int col = rows[i].numSites;
-    for(int j = 0; j < col; j++) {
-      grid_2[i][j].name = "pixel_" + to_string(i) + "_" + to_string(j);
-      grid_2[i][j].y_pos = i;
-      grid_2[i][j].x_pos = j;
-      grid_2[i][j].linked_cell = NULL;
-    }
-  }
-
+// cell span on one row, for the overlap sweep
+struct row_span {
+  int y_pos;
+  int x_begin;
+  int x_end;
+  unsigned cell;
+};
+
+// sorts placed cells into per-row spans and sweeps each row left to right :
+// overlaps, edge spacing and cells out of the rows in O(n log n)
+void circuit::overlap_check(vector< violation >& violations) {
+  int row_num = IntConvert(die.yUR / rowHeight);
+  int col_num = IntConvert(die.xUR / wsite);
+
+  vector< row_span > spans;
+  spans.reserve(cells.size());
   for(int i = 0; i < cells.size(); i++) {
     cell* theCell = &cells[i];
+    if(theCell->isPlaced == false) continue;
     int x_pos = (int)floor(theCell->x_coord / wsite + 0.5);
     int y_pos = (int)floor(theCell->y_coord / rowHeight + 0.5);
-    int x_step = (int)ceil(theCell->width / wsite);
-    int y_step = (int)ceil(theCell->height / rowHeight);
-
-
-    int x_ur = x_pos + x_step;
-    int y_ur = y_pos + y_step;
+    int x_ur = x_pos + (int)ceil(theCell->width / wsite);
+    int y_ur = y_pos + (int)ceil(theCell->height / rowHeight);
 
     // Fixed Cell can be out of Current DIEAREA settings.
-    if( theCell->isFixed ) {
-      x_pos = max(0, x_pos); 
+    if(theCell->isFixed) {
+      x_pos = max(0, x_pos);
       y_pos = max(0, y_pos);
-      x_ur = min(x_ur, IntConvert(die.xUR / wsite));
-      y_ur = min(y_ur, IntConvert(die.yUR / rowHeight));
+      x_ur = min(x_ur, col_num);
+      y_ur = min(y_ur, row_num);
     }
-   
-//    cout << theCell->width / wsite << endl; 
-//    cout << theCell->height / rowHeight << endl; 
-//    cout << "x: " << x_pos << " " << x_ur << endl;
-//    cout << "y: " << y_pos << " " << y_ur << endl;
-
-    assert(x_pos > -1);
-    assert(y_pos > -1);
-    assert(x_step > 0);
-    assert(y_step > 0);
-    assert(x_ur <= (int)floor(die.xUR / wsite + 0.5));
-    assert(y_ur <= (int)floor(die.yUR / rowHeight + 0.5));
-
-
-    for(int j = y_pos; j < y_ur; j++) {
-      for(int k = x_pos; k < x_ur; k++) {
-        if(grid_2[j][k].linked_cell == NULL) {
-          grid_2[j][k].linked_cell = theCell;
-          grid_2[j][k].util = 1.0;
-        }
-        else {
-          log << "overlap_check ==> FAIL!! ( cell " << theCell->name
-              << " is overlap with " << grid_2[j][k].linked_cell->name << " ) "
-              << " ( " 
-              << IntConvert(k*wsite + core.xLL) << ", " 
-              << IntConvert(j*rowHeight + core.yLL) << " )" 
-              << endl;
-          valid = false;
+    else if(x_pos < 0 || y_pos < 0 || x_ur > col_num || y_ur > row_num) {
+      violations.push_back(
+          violation(BOUND_VIOLATION, theCell->id, x_pos, y_pos));
+      x_pos = max(0, x_pos);
+      y_pos = max(0, y_pos);
+      x_ur = min(x_ur, col_num);
+      y_ur = min(y_ur, row_num);
+    }
+
+    for(int j = y_pos; j < y_ur && x_pos < x_ur; j++) {
+      row_span span;
+      span.y_pos = j;
+      span.x_begin = x_pos;
+      span.x_end = x_ur;
+      span.cell = theCell->id;
+      spans.push_back(span);
+    }
+  }
+  sort(spans.begin(), spans.end(), [](const row_span& a, const row_span& b) {
+    return a.y_pos < b.y_pos || (a.y_pos == b.y_pos && a.x_begin < b.x_begin);
+  });
+
+  // reach : span reaching furthest right so far in the current row
+  row_span* reach = NULL;
+  for(int i = 0; i < spans.size(); i++) {
+    row_span* span = &spans[i];
+    if(reach != NULL && reach->y_pos != span->y_pos) reach = NULL;
+    if(reach == NULL) {
+      reach = span;
+      continue;
+    }
+
+    if(span->x_begin < reach->x_end) {
+      violation theViolation(OVERLAP_VIOLATION, span->cell, span->x_begin,
+                             span->y_pos);
+      theViolation.other = reach->cell;
+      violations.push_back(theViolation);
+    }
+    else {
+      macro* left_macro = &macros[cells[reach->cell].type];
+      macro* right_macro = &macros[cells[span->cell].type];
+      if(left_macro->edgetypeRight != 0 && right_macro->edgetypeLeft != 0) {
+        int space =
+            (int)floor(edge_spacing[make_pair(left_macro->edgetypeRight,
+                                              right_macro->edgetypeLeft)] /
+                           wsite +
+                       0.5);
+        int cell_dist = span->x_begin - reach->x_end;
+        if(cell_dist < space) {
+          violation theViolation(EDGE_VIOLATION, span->cell, span->x_begin,
+                                 span->y_pos);
+          theViolation.other = reach->cell;
+          theViolation.value = cell_dist;
+          theViolation.limit = space;
+          violations.push_back(theViolation);
         }
       }
     }
+    if(span->x_end > reach->x_end) reach = span;
   }
-  if(valid == false)
-    cout << " overlap_check ==>> FAIL " << endl;
-  else
-    cout << " overlap_check ==>> PASS " << endl;
   return;
 }
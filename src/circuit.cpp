@@ -56,11 +56,10 @@ viaRule::viaRule() : name("") {};
 
 via::via() : name(""), viaRule(""), property("") {};
 
-macro_pin::macro_pin() : direction(""), shape(""), layer(0) {};
+macro_pin::macro_pin() : name(""), direction(""), shape(""), layer(0) {};
 
 macro::macro()
-  : name(""),
-    type(""),
+  : type(""),
     isFlop(false),
     isMulti(false),
     xOrig(0.0),
@@ -68,11 +67,7 @@ macro::macro()
     width(0.0),
     height(0.0),
     edgetypeLeft(0),
-    edgetypeRight(0) {
-#ifdef USE_GOOGLE_HASH
-  pins.set_empty_key(INITSTR);
-#endif
-}
+    edgetypeRight(0) {}
 
 void macro::print() {
   cout << "|=== BEGIN MACRO ===|" << endl;
@@ -83,18 +78,17 @@ void macro::print() {
   for(unsigned i = 0; i < sites.size(); ++i) {
     cout << "sites[" << i << "]: " << sites[i] << endl;
   }
-  for(OPENDP_HASH_MAP< string, macro_pin >::iterator it = pins.begin();
-      it != pins.end(); it++) {
-    cout << "pins: " << (*it).first << endl;
+  for(unsigned i = 0; i < pins.size(); ++i) {
+    cout << "pins: " << pins[i].name << endl;
   }
   cout << "|=== BEGIN MACRO ===|" << endl;
 }
 
 
 pin::pin() 
-  : name(""),
-    id(UINT_MAX),
+  : id(UINT_MAX),
     owner(UINT_MAX),
+    mpin(UINT_MAX),
     net(UINT_MAX),
     type(UINT_MAX),
     isFlopInput(false),
@@ -107,11 +101,11 @@ pin::pin()
 
 void pin::print() {
   cout << "|=== BEGIN PIN ===|  " << endl;
-  cout << "name:                " << name << endl;
   cout << "id:                  " << id << endl;
   cout << "type:                " << type << endl;
   cout << "net:                 " << net << endl;
   cout << "pin owner:           " << owner << endl;
+  cout << "macro pin:           " << mpin << endl;
   cout << "isFixed?             " << (isFixed ? "yes" : "no") << endl;
   cout << "(x_coord,y_coord):   " << x_coord << ", " << y_coord << endl;
   cout << "(x_offset,y_offset): " << x_offset << ", " << y_offset << endl;
@@ -119,9 +113,8 @@ void pin::print() {
 }
   
 cell::cell()
-      : name(""),
+      : id(UINT_MAX),
         type(UINT_MAX),
-        id(UINT_MAX),
         x_coord(0),
         y_coord(0),
         init_x_coord(0),
@@ -130,34 +123,66 @@ cell::cell()
         y_pos(INT_MAX),
         width(0.0),
         height(0.0),
+        disp(0),
+        group(UINT_MAX),
         isFixed(false),
         isPlaced(false),
         inGroup(false),
         hold(false),
-        region(UINT_MAX),
-        cellorient(""),
-        group(""),
-        dense_factor(0.0),
-        dense_factor_count(0),
-        binId(UINT_MAX),
-        disp(0.0) {
-#ifdef USE_GOOGLE_HASH
-    ports.set_empty_key(INITSTR);
-#endif
-}
+        cellorient(ORIENT_N) {}
+
+cell_info::cell_info() : region(UINT_MAX), dense_factor(0.0) {}
 
 
 pixel::pixel()
-  : name(""),
-    util(0.0),
-    x_pos(0.0),
-    y_pos(0.0),
-    group(UINT_MAX),
-    linked_cell(NULL),
-    isValid(true) {};
+  : x_pos(0),
+    y_pos(0) {};
+
+pixel::pixel(int x, int y)
+  : x_pos(x),
+    y_pos(y) {};
+
+string pixel::name() const {
+  return "pixel_" + std::to_string(y_pos) + "_" + std::to_string(x_pos);
+}
+
+pixel_grid::pixel_grid() 
+  : row_num(0), col_num(0), words_per_row(0), group_num(0) {};
+
+void pixel_grid::init(int rows, int cols) {
+  row_num = rows;
+  col_num = cols;
+  words_per_row = (cols + 63) / 64;
+  size_t num = static_cast< size_t >(rows) * cols;
+  linked_cell.assign(num, PIXEL_EMPTY);
+  group.assign(num, PIXEL_NO_GROUP);
+  isValid.assign(num, false);
+
+  size_t num_words = static_cast< size_t >(rows) * words_per_row;
+  occupied.assign(num_words, 0);
+  legal[0].assign(num_words, 0);
+  legal[1].assign(num_words, 0);
+  group_num = 0;
+  seg_begin.assign(1, 0);
+  col_seg.assign(cols, 0);
+  gaps.assign(rows, std::vector< free_gap >());
+}
+
+void pixel_grid::clear() {
+  row_num = col_num = words_per_row = group_num = 0;
+  std::vector< unsigned >().swap(linked_cell);
+  std::vector< unsigned short >().swap(group);
+  std::vector< bool >().swap(isValid);
+  std::vector< uint64_t >().swap(occupied);
+  std::vector< uint64_t >().swap(legal[0]);
+  std::vector< uint64_t >().swap(legal[1]);
+  std::vector< int >().swap(seg_begin);
+  std::vector< unsigned short >().swap(col_seg);
+  std::vector< std::vector< free_gap > >().swap(gaps);
+}
 
 net::net() 
-  : name(""), source(UINT_MAX) {};
+  : source(UINT_MAX) {};
 
 row::row()
       : name(""),
@@ -167,7 +192,7 @@ row::row()
         stepX(0),
         stepY(0),
         numSites(0),
-        siteorient("") {};
+        siteorient(ORIENT_N) {};
 
 group::group() : name(""), type(""), tag(""), util(0.0) {};
 
@@ -184,6 +209,10 @@ sub_region::sub_region()
   siblings.reserve(8192);
 }
 
+violation::violation(violation_type t, unsigned c, int x, int y)
+  : type(t), cell(c), other(UINT_MAX), x_pos(x), y_pos(y), value(0),
+    limit(0) {};
+
 
   
 void layer::print() {
@@ -202,19 +231,32 @@ circuit::circuit()
   : GROUP_IGNORE(false),
     num_fixed_nodes(0),
     num_cpu(1),
+    strip_placement(false),
+    lazy_nets(false),
+    cluster_engine(false),
     DEFVersion(""),
     DEFDelimiter("/"),
     DEFBusCharacters("[]"),
     design_name(""),
     DEFdist2Microns(0),
     sum_displacement(0.0),
+    disp_sum(0),
+    hpwl_dirty(0),
+    hpwl_sum(0.0),
+    init_hpwl(0.0),
+    undo_depth(0),
     displacement(400.0),
     max_disp_const(0.0),
     max_utilization(100.0),
     wsite(0),
     max_cell_height(1),
-    rowHeight(0.0f), 
-    fileOut(0) {
+    rowHeight(0.0f),
+    def_comps_begin(-1),
+    def_comps_end(-1),
+    def_prelude_end(-1),
+    def_nets_begin(-1),
+    def_nets_end(-1),
+    nets_deferred(false) {
 
   macros.reserve(128);
   layers.reserve(32);
@@ -223,13 +265,13 @@ circuit::circuit()
 
 #ifdef USE_GOOGLE_HASH
   macro2id.set_empty_key(
-      INITSTR); /* OPENDP_HASH_MAP between macro name and ID */
+      opendp::name_key(INITSTR)); /* OPENDP_HASH_MAP between macro name and ID */
   cell2id.set_empty_key(
-      INITSTR); /* OPENDP_HASH_MAP between cell  name and ID */
+      opendp::name_key(INITSTR)); /* OPENDP_HASH_MAP between cell  name and ID */
   pin2id.set_empty_key(
       INITSTR); /* OPENDP_HASH_MAP between pin   name and ID */
   net2id.set_empty_key(
-      INITSTR); /* OPENDP_HASH_MAP between net   name and ID */
+      opendp::name_key(INITSTR)); /* OPENDP_HASH_MAP between net   name and ID */
   row2id.set_empty_key(
       INITSTR); /* OPENDP_HASH_MAP between row   name and ID */
   site2id.set_empty_key(
@@ -46,12 +46,18 @@
 #include <vector>
 #include <map>
 #include <cmath>
+#include <cfloat>
 #include <climits>
 #include <algorithm>
 #include <limits>
 #include <assert.h>
 #include <queue>
+#include <random>
+#include <stdint.h>
+#include <memory>
+#ifdef _OPENMP
 #include <omp.h>
+#endif
 #include "mymeasure.h"
 
 // hashmap settings
@@ -71,10 +77,117 @@
 #define PO_PIN 2
 #define NONPIO_PIN 3
 
+// pixel grid occupancy
+#define PIXEL_EMPTY UINT_MAX
+#define PIXEL_DUMMY (UINT_MAX - 1)
+#define PIXEL_NO_GROUP USHRT_MAX
+
+// sites between sub_region strip interiors left to the serial halo pass
+// ( >= 32, so two interiors never share an occupancy bitmap word )
+#define STRIP_HALO 64
+
+// proposals per movable cell in one swap_annealing pass
+#define SWAP_MOVES_PER_CELL 20
+
+// bytes per name_pool chunk
+#define NAME_POOL_CHUNK (1 << 20)
+
 namespace opendp {
 
 enum power { VDD, VSS };
 
+// DEF orientation, in defiComponent::placementOrient() order
+enum orient {
+  ORIENT_N,
+  ORIENT_W,
+  ORIENT_S,
+  ORIENT_E,
+  ORIENT_FN,
+  ORIENT_FW,
+  ORIENT_FS,
+  ORIENT_FE
+};
+
+// which coordinate of a cell a move starts from
+enum coord_mode {
+  MODE_INIT_COORD, /* init_x_coord, init_y_coord */
+  MODE_COORD,      /* x_coord, y_coord */
+  MODE_POS         /* x_pos, y_pos ( in sites / rows ) */
+};
+
+// handle to a name interned in a name_pool ( or a string literal ); the
+// characters are never moved or freed while the pool lives
+struct name_ref {
+  const char* ptr; /* '\0' terminated */
+  unsigned len;
+
+  name_ref() : ptr(""), len(0) {}
+  name_ref(const char* s, unsigned n) : ptr(s), len(n) {}
+  const char* c_str() const { return ptr; }
+  unsigned size() const { return len; }
+  bool empty() const { return len == 0; }
+  std::string str() const { return std::string(ptr, len); }
+  bool operator==(const name_ref& rhs) const {
+    return len == rhs.len && memcmp(ptr, rhs.ptr, len) == 0;
+  }
+  bool operator!=(const name_ref& rhs) const { return !(*this == rhs); }
+  bool operator<(const name_ref& rhs) const {
+    int c = memcmp(ptr, rhs.ptr, std::min(len, rhs.len));
+    return c < 0 || (c == 0 && len < rhs.len);
+  }
+  bool operator==(const std::string& rhs) const {
+    return len == rhs.size() && memcmp(ptr, rhs.data(), len) == 0;
+  }
+  bool operator!=(const std::string& rhs) const { return !(*this == rhs); }
+  bool operator==(const char* rhs) const {
+    return strncmp(ptr, rhs, len) == 0 && rhs[len] == '\0';
+  }
+};
+
+// lookup key for a name not interned yet
+inline name_ref name_key(const std::string& s) {
+  return name_ref(s.c_str(), s.size());
+}
+inline name_ref name_key(const char* s) { return name_ref(s, strlen(s)); }
+
+// index of key in a *2id map, UINT_MAX if absent. operator[] must not be
+// used with a key that is not interned
+template < class Map >
+unsigned find_id(const Map& ids, name_ref key) {
+  typename Map::const_iterator it = ids.find(key);
+  return (it == ids.end()) ? UINT_MAX : it->second;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const name_ref& name) {
+  return os.write(name.ptr, name.len);
+}
+
+struct name_hash {
+  size_t operator()(const name_ref& name) const {
+    // FNV-1a
+    size_t h = 14695981039346656037ULL;
+    for(unsigned i = 0; i < name.len; i++) {
+      h = (h ^ (unsigned char)name.ptr[i]) * 1099511628211ULL;
+    }
+    return h;
+  }
+};
+
+// append-only arena holding the names of cells, nets and macros; the
+// *2id maps keep one copy of each name
+class name_pool {
+ public:
+  name_pool() : used(0), cap(0) {}
+  name_ref intern(const char* s, size_t len);
+  name_ref intern(const std::string& s) { return intern(s.c_str(), s.size()); }
+
+ private:
+  std::vector< std::unique_ptr< char[] > > chunks;
+  size_t used, cap; /* in chunks.back() */
+  name_pool(const name_pool&);
+  name_pool& operator=(const name_pool&);
+};
+
 struct rect {
   double xLL, yLL;
   double xUR, yUR;
@@ -159,6 +272,7 @@ struct via {
 };
 
 struct macro_pin {
+  std::string name;
   std::string direction;
 
   std::vector< rect > port;
@@ -169,7 +283,7 @@ struct macro_pin {
 };
 
 struct macro {
-  std::string name;
+  name_ref name; /* in circuit::names */
   std::string type;        /* equivalent to class, I/O pad or CORE */
   bool isFlop;        /* clocked element or not */
   bool isMulti;       /* single row = false , multi row = true */
@@ -181,20 +295,23 @@ struct macro {
   int edgetypeRight;  // 1 or 2
   std::vector< unsigned > sites;
 
-  OPENDP_HASH_MAP< std::string, macro_pin > pins;
+  std::vector< macro_pin > pins; /* numbered in LEF order */
 
   std::vector< rect > obses; /* keyword OBS for non-rectangular shapes in micros */
   power top_power;      // VDD = 0  VSS = 1 enum
 
   macro();
   void print();
+  int find_pin(const char* pinName) const; /* index to pins, -1 if none */
+  macro_pin* locateOrCreatePin(const std::string& pinName);
 };
 
+// design pin. pins of cells carry no name; circuit::pin_name builds it
+// from the owner and the macro pin
 struct pin {
-  // from verilog
-  std::string name; /* Name of pins : instance name + "_" + port_name */
   unsigned id;
   unsigned owner; /* The owners of PIs or POs are UINT_MAX */
+  unsigned mpin;  /* index to the owner macro's pins */
   unsigned net;
   unsigned type;    /* 1=PI_PIN, 2=PO_PIN, 3=others */
   bool isFlopInput; /* is this pin an input  of a clocked element? */
@@ -210,47 +327,154 @@ struct pin {
   void print();
 };
 
+// placement state of a cell : the fields every sweep ( displacement, HPWL,
+// legality checks, pixel painting ) touches, packed into one 64-byte line.
+// Attributes read only while parsing, reporting or ordering live in
+// circuit::cell_infos under the same id
 struct cell {
-  std::string name;
   unsigned id;
   unsigned type;                  /* index to some predefined macro */
   int x_coord, y_coord;           /* (in DBU) */
   int init_x_coord, init_y_coord; /* (in DBU) */
   int x_pos, y_pos;               /* (in DBU) */
   double width, height;           /* (in DBU) */
-  bool isFixed;                   /* fixed cell or not */
+  int disp;                       /* |x - init_x| + |y - init_y| (in DBU) */
+  unsigned group; /* index to groups, UINT_MAX if none */
+  bool isFixed;   /* fixed cell or not */
   bool isPlaced;
   bool inGroup;
   bool hold;
-  unsigned region;
-  OPENDP_HASH_MAP< std::string, unsigned > ports; /* <port name, index to the pin> */
-  std::string cellorient;
-  std::string group;
-
-  double dense_factor;
-  int dense_factor_count;
-  unsigned binId;
-  double disp;
+  orient cellorient;
 
   cell();
   void print();
 };
 
+// cold attributes of cells[id]
+struct cell_info {
+  name_ref name;       /* in circuit::names */
+  unsigned region;     /* index to groups[group].regions */
+  double dense_factor; /* local bin density, see calc_density_factor */
+
+  cell_info();
+};
+
+// site coordinate on the pixel grid
 struct pixel {
-  std::string name;
-  double util;
   int x_pos;
   int y_pos;
-  unsigned group;  // group id
-
-  cell* linked_cell;
-  bool isValid;  // false for dummy place
 
   pixel();
+  pixel(int x, int y);
+  std::string name() const; /* "pixel_y_x", only built for diagnostics */
+};
+
+// compact pixel grid : flat row-major arrays, one entry per site
+// maximal run of free sites [start, end) in one row sharing a group
+struct free_gap {
+  int start;
+  int end;
+  unsigned short group; /* index to groups, PIXEL_NO_GROUP */
+};
+
+struct pixel_grid {
+  int row_num;
+  int col_num;
+  std::vector< unsigned > linked_cell;   /* index to cells, PIXEL_EMPTY or PIXEL_DUMMY */
+  std::vector< unsigned short > group;   /* index to groups, PIXEL_NO_GROUP */
+  std::vector< bool > isValid;           /* false for dummy place */
+
+  // per-row 64-bit bitmaps for word-parallel free run search
+  int words_per_row;
+  std::vector< uint64_t > occupied;      /* linked_cell != PIXEL_EMPTY */
+  std::vector< uint64_t > legal[2];      /* valid sites : [0] no group, [1] in group */
+
+  // free gaps per ( row, bucket ) sorted by start, kept by paint / erase.
+  // a bucket is one group, or one column segment of the no group sites, so
+  // distinct groups and disjoint segments can be painted concurrently
+  int group_num;
+  std::vector< int > seg_begin;           /* first column of each segment */
+  std::vector< unsigned short > col_seg;  /* segment of each column */
+  std::vector< std::vector< free_gap > > gaps;
+
+  pixel_grid();
+  void init(int rows, int cols);
+  void clear();
+
+  // pixel_grid.cpp
+  void build_bitmaps();
+  void build_gaps();
+  void set_segments(const std::vector< int >& begins);
+  void paint(int y, int x, int x_step, int y_step, unsigned cellId);
+  void erase(int y, int x, int x_step, int y_step);
+  void take_gap(int y, int x_begin, int x_end);
+  void give_gap(int y, int x_begin, int x_end);
+  // first / last site in [x_begin, x_end) of rows [y, y + y_step) that
+  // can not take a cell of groupId ( UINT_MAX : no group ), -1 if none
+  int next_blocked(int y, int y_step, int x_begin, int x_end,
+                   unsigned groupId) const;
+  int prev_blocked(int y, int y_step, int x_begin, int x_end,
+                   unsigned groupId) const;
+  // first occupied site in [x_begin, x_end) of row y, -1 if none
+  int next_occupied(int y, int x_begin, int x_end) const;
+  // bit i set : sites [x + i, x + i + run) of rows [y, y + y_step) are
+  // free for a cell of groupId ( i < count, count + run <= 65 )
+  uint64_t free_run_starts(int y, int y_step, int x, int count, int run,
+                           unsigned groupId) const;
+  // smallest x' in [x, x_max] ( largest x' in [x_min, x] ) such that sites
+  // [x', x' + run) of rows [y, y + y_step) are free for a cell of groupId,
+  // -1 if none
+  int fit_right(int y, int y_step, int x, int run, unsigned groupId,
+                int x_max) const;
+  int fit_left(int y, int y_step, int x, int run, unsigned groupId,
+               int x_min) const;
+
+  size_t index(int y, int x) const {
+    return static_cast< size_t >(y) * col_num + x;
+  }
+  unsigned cell_at(int y, int x) const { return linked_cell[index(y, x)]; }
+  unsigned group_at(int y, int x) const {
+    unsigned short g = group[index(y, x)];
+    return (g == PIXEL_NO_GROUP) ? UINT_MAX : g;
+  }
+  bool valid_at(int y, int x) const { return isValid[index(y, x)]; }
+  size_t bucket(int y, int x, unsigned short g) const {
+    size_t base = static_cast< size_t >(y) * (group_num + seg_begin.size());
+    return base + ((g == PIXEL_NO_GROUP) ? group_num + col_seg[x] : g);
+  }
+  std::vector< free_gap >& row_gaps(int y, int x, unsigned short g) {
+    return gaps[bucket(y, x, g)];
+  }
+  const std::vector< free_gap >& row_gaps(int y, int x,
+                                          unsigned short g) const {
+    return gaps[bucket(y, x, g)];
+  }
 };
 
+// placement status keyword of a DEF component
+enum def_status {
+  DEF_NO_STATUS,
+  DEF_FIXED,
+  DEF_COVER,
+  DEF_PLACED,
+  DEF_UNPLACED
+};
+
+// one COMPONENTS statement of the input DEF; write_def regenerates it from
+// the cell and the attribute text kept in circuit::def_component_text
+struct def_component {
+  unsigned cell;      /* index to cells */
+  def_status status;
+  size_t text;        /* offset into def_component_text */
+  unsigned nets_len;  /* "net net " right after the macro name */
+  unsigned extra_len; /* attributes after the placement, follow the nets */
+};
+
+// buffered DEF output, gzip-compressed for .gz names ( parser.cpp )
+class def_writer;
+
 struct net {
-  std::string name;
+  name_ref name; /* in circuit::names */
   unsigned source;          /* input pin index to the net */
   std::vector< unsigned > sinks; /* sink pins indices of the net */
 
@@ -267,7 +491,7 @@ struct row {
   int stepX; /* (in DBU) */
   int stepY; /* (in DBU) */
   int numSites;
-  std::string siteorient;
+  orient siteorient;
   power top_power;
 
   std::vector< cell* > cell_list;
@@ -282,7 +506,6 @@ struct group {
   std::string tag;
   std::vector< rect > regions;
   std::vector< cell* > siblings;
-  std::vector< pixel* > pixels;
   rect boundary;
   double util;
 
@@ -298,6 +521,38 @@ struct sub_region {
   sub_region();
 };
 
+enum violation_type {
+  ROW_VIOLATION,     /* y_coord off the row grid */
+  SITE_VIOLATION,    /* x_coord off the site grid */
+  POWER_VIOLATION,   /* orient / row does not match the power rails */
+  EDGE_VIOLATION,    /* edge spacing to the left neighbor too small */
+  PLACED_VIOLATION,  /* cell never placed */
+  OVERLAP_VIOLATION, /* cell overlaps another */
+  BOUND_VIOLATION,   /* cell outside the rows */
+  NUM_VIOLATION_TYPES
+};
+
+// one paint_pixel / erase_pixel made inside a move transaction
+struct pixel_change {
+  unsigned cell;
+  bool painted; /* false : erased */
+  int x_pos, y_pos;
+  bool hold; /* before an erase */
+};
+
+// one legality check failure
+struct violation {
+  violation_type type;
+  unsigned cell;  /* index to cells */
+  unsigned other; /* neighbor of edge / overlap violations, UINT_MAX else */
+  int x_pos;      /* site of the violation */
+  int y_pos;      /* row of the violation */
+  int value;      /* edge : spacing in sites */
+  int limit;      /* edge : required spacing in sites */
+
+  violation(violation_type t, unsigned c, int x, int y);
+};
+
 struct density_bin {
   double lx, hx;     /* low/high x coordinate */
   double ly, hy;     /* low/high y coordinate */
@@ -325,13 +580,13 @@ class circuit {
   bool GROUP_IGNORE;
 
   void init_large_cell_stor();
-  OPENDP_HASH_MAP< std::string, unsigned >
+  OPENDP_HASH_MAP< name_ref, unsigned, name_hash >
       macro2id; /* OPENDP_HASH_MAP between macro name and ID */
-  OPENDP_HASH_MAP< std::string, unsigned >
+  OPENDP_HASH_MAP< name_ref, unsigned, name_hash >
       cell2id; /* OPENDP_HASH_MAP between cell  name and ID */
   OPENDP_HASH_MAP< std::string, unsigned >
-      pin2id; /* OPENDP_HASH_MAP between pin   name and ID */
-  OPENDP_HASH_MAP< std::string, unsigned >
+      pin2id; /* OPENDP_HASH_MAP between PI/PO name and ID */
+  OPENDP_HASH_MAP< name_ref, unsigned, name_hash >
       net2id; /* OPENDP_HASH_MAP between net   name and ID */
   OPENDP_HASH_MAP< std::string, unsigned >
       row2id; /* OPENDP_HASH_MAP between row   name and ID */
@@ -353,6 +608,22 @@ class circuit {
   double max_displacement;
   double avg_displacement;
 
+  // running objective stats, kept current by paint_pixel / erase_pixel
+  long long disp_sum; /* sum of cell->disp ( DBU ) */
+  std::priority_queue< std::pair< int, unsigned > >
+      disp_heap; /* ( disp, cell ), stale entries skipped on query */
+  std::vector< unsigned > cell_net_start; /* cell i's nets in */
+  std::vector< unsigned > cell_nets;      /* [start[i], start[i + 1]) */
+  std::vector< double > net_box;  /* MODE_COORD half perimeter ( DBU ) */
+  std::vector< char > net_dirty;  /* net_box needs recompute */
+  char hpwl_dirty;
+  double hpwl_sum;  /* sum of net_box */
+  double init_hpwl; /* HPWL( MODE_INIT_COORD ) */
+
+  // undo log of the open move transactions ( serial callers only )
+  std::vector< pixel_change > undo_log;
+  int undo_depth;
+
   unsigned num_fixed_nodes;
   double total_mArea; /* total movable cell area */
   double total_fArea; /* total fixed cell area (excluding terminal NIs) */
@@ -372,6 +643,10 @@ class circuit {
   int wsite;
   int max_cell_height;
   unsigned num_cpu;
+  bool strip_placement; /* place non group cells per sub_region strip */
+  bool lazy_nets;       /* ReadDef skips NETS until HPWL is asked for */
+  bool cluster_engine;  /* legalize with cluster_placement */
+  std::string lef_cache_dir; /* ReadLef keeps parsed libraries here if set */
 
   std::string out_def_name;
   std::string in_def_name;
@@ -380,7 +655,7 @@ class circuit {
   std::string benchmark; /* benchmark name */
 
   // 2D - pixel grid;
-  pixel** grid;
+  pixel_grid grid;
   cell dummy_cell;
   std::vector< sub_region > sub_regions;
   std::vector< track > tracks;
@@ -404,12 +679,33 @@ class circuit {
   unsigned DEFdist2Microns;
   std::vector< std::pair< unsigned, unsigned > > dieArea;
 
+  name_pool names; /* cell / net / macro names */
   std::vector< site > sites;   /* site list */
   std::vector< layer > layers; /* layer list */
   std::vector< macro > macros; /* macro list */
   std::vector< cell > cells;   /* cell list */
+  std::vector< cell_info > cell_infos; /* cold side of cells, same index */
   std::vector< net > nets;     /* net list */
   std::vector< pin > pins;     /* pin list */
+
+  // pins of cells by ( cell, macro pin ) : cell_pin[cell_pin_start[c] + k],
+  // UINT_MAX if unconnected. Filled by locateOrCreateCellPin
+  std::vector< unsigned > cell_pin_start;
+  std::vector< unsigned > cell_pin;
+
+  // input DEF COMPONENTS body [def_comps_begin, def_comps_end) in bytes,
+  // -1 if none; write_def copies the rest of the file verbatim
+  long long def_comps_begin;
+  long long def_comps_end;
+  std::vector< def_component > def_components; /* in input order */
+  std::string def_component_text;
+
+  // lazy_nets : input DEF NETS statement [def_nets_begin, def_nets_end) and
+  // the header [0, def_prelude_end) ReadDefNets parses it with
+  long long def_prelude_end;
+  long long def_nets_begin;
+  long long def_nets_end;
+  bool nets_deferred; /* nets / net pins not read yet */
   
   std::vector< row > prevrows;     // fragmented row list
   std::vector< row > rows;     /* row list */
@@ -420,16 +716,23 @@ class circuit {
 
   std::vector< std::pair< double, cell* > > large_cell_stor;
 
+  std::vector< unsigned > cell_name_order; /* cells sorted by name */
+
   /* locateOrCreate helper functions - parser_helper.cpp */
-  macro* locateOrCreateMacro(const std::string& macroName);
-  cell* locateOrCreateCell(const std::string& cellName);
-  net* locateOrCreateNet(const std::string& netName);
-  pin* locateOrCreatePin(const std::string& pinName);
+  macro* locateOrCreateMacro(name_ref macroName);
+  cell* locateOrCreateCell(name_ref cellName);
+  net* locateOrCreateNet(name_ref netName);
+  pin* locateOrCreatePin(const std::string& pinName); /* PI/PO */
+  pin* locateOrCreateCellPin(unsigned cellId, unsigned macroPin);
+  void init_cell_pins();
+  std::string pin_name(unsigned pinId);
+  name_ref cell_name(const cell* theCell) const;
   row* locateOrCreateRow(const std::string& rowName);
   site* locateOrCreateSite(const std::string& siteName);
   layer* locateOrCreateLayer(const std::string& layerName);
   via* locateOrCreateVia(const std::string& viaName);
   group* locateOrCreateGroup(const std::string& groupName);
+  void add_group_members(group* theGroup, const std::string& pattern);
   void print();
 
   /* IO helpers for LEF - parser.cpp */
@@ -451,13 +754,19 @@ class circuit {
   void read_def_pins(std::ifstream& is);
   void read_def_special_nets(std::ifstream& is);
   void read_def_nets(std::ifstream& is);
+  pin* read_def_net_pin(const std::string& owner, const std::string& pinName);
   void read_def_regions(std::ifstream& is);
   void read_def_groups(std::ifstream& is);
   void write_def(const std::string& output);
+  void write_def_components(def_writer& out);
 
-  void WriteDefComponents(const std::string& inputDef);
-
-  FILE* fileOut;
+  // snapshot.cpp - binary image of the initialized circuit
+  bool save_snapshot(const std::string& file);
+  bool load_snapshot(const std::string& file);
+  // and of the parsed LEF library ( macros, sites, layers )
+  std::string lef_cache_file(const std::vector< std::string >& lefStor);
+  bool save_lef_cache(const std::string& file);
+  bool load_lef_cache(const std::string& file);
 
   circuit();
 
@@ -476,6 +785,7 @@ class circuit {
 
   // Si2 parsing engine
   int ReadDef(const std::string& input);
+  int ReadDefNets();
   // int DefVersionCbk(defrCallbackType_e c, const char* versionName, defiUserData ud);
   // int DefDividerCbk(defrCallbackType_e c, const char* h, defiUserData ud);
   // int DefDesignCbk(defrCallbackType_e c, const char* std::string, defiUserData ud);
@@ -493,49 +803,74 @@ class circuit {
   void power_mapping();
   void evaluation();
   double Disp();
-  double HPWL(std::string mode);
+  double HPWL(coord_mode mode);
+  double net_hpwl(net* theNet, coord_mode mode);
+  void init_stats();
+  void init_net_stats();
+  void load_nets();
+  void track_move(cell* theCell);
+  double current_sum_disp();
+  double current_max_disp();
+  double current_hpwl();
+  double initial_hpwl();
   double calc_density_factor(double unit);
 
   void group_analyze();
   std::pair< int, int > nearest_coord_to_rect_boundary(cell* theCell, rect* theRect,
-                                                  std::string mode);
-  int dist_for_rect(cell* theCell, rect* theRect, std::string mode);
+                                                  coord_mode mode);
+  int dist_for_rect(cell* theCell, rect* theRect, coord_mode mode);
   bool check_overlap(rect cell, rect box);
-  bool check_overlap(cell* theCell, rect* theRect, std::string mode);
+  bool check_overlap(cell* theCell, rect* theRect, coord_mode mode);
   bool check_inside(rect cell, rect box);
-  bool check_inside(cell* theCell, rect* theRect, std::string mode);
+  bool check_inside(cell* theCell, rect* theRect, coord_mode mode);
   std::pair< bool, std::pair< int, int > > bin_search(int x_pos, cell* theCell, int x,
                                             int y);
-  std::pair< bool, pixel* > diamond_search(cell* theCell, int x, int y);
-  bool direct_move(cell* theCell, std::string mode);
+  std::pair< bool, pixel > diamond_search(cell* theCell, int x, int y,
+                                          int col_begin = 0,
+                                          int col_end = INT_MAX);
+  bool direct_move(cell* theCell, coord_mode mode);
   bool direct_move(cell* theCell, int x, int y);
   bool shift_move(cell* theCell, int x, int y);
-  bool shift_move(cell* theCell, std::string mode);
-  bool map_move(cell* theCell, std::string mode);
+  bool shift_move(cell* theCell, coord_mode mode);
+  bool rip_up_move(cell* theCell, int x, int y, int window, bool large_first);
+  size_t begin_moves();
+  void commit_moves(size_t mark);
+  void rollback_moves(size_t mark);
+  bool map_move(cell* theCell, coord_mode mode);
   bool map_move(cell* theCell, int x, int y);
   std::vector< cell* > overlap_cells(cell* theCell);
   std::vector< cell* > get_cells_from_boundary(rect* theRect);
+  void window_cells(int x_begin, int y_begin, int x_end, int y_end,
+                    std::vector< cell* >& list);
   double dist_benefit(cell* theCell, int x_coord, int y_coord);
   bool swap_cell(cell* cellA, cell* cellB);
-  bool refine_move(cell* theCell, std::string mode);
+  bool refine_move(cell* theCell, coord_mode mode);
   bool refine_move(cell* theCell, int x_coord, int y_coord);
-  pixel* get_pixel(int x_pos, int y_pos);
+  pixel get_pixel(int x_pos, int y_pos);
+  cell* pixel_cell(int y_pos, int x_pos);
   std::pair< bool, cell* > nearest_cell(int x_coord, int y_coord);
 
   // place.cpp - By SGD
   void simple_placement(CMeasure* measure = nullptr);
   void non_group_cell_pre_placement();
   void group_cell_pre_placement();
-  void non_group_cell_placement(std::string mode);
-  void group_cell_placement(std::string mode);
-  void group_cell_placement(std::string mode, std::string mode2);
+  void non_group_cell_placement(coord_mode mode);
+  void strip_cell_placement(coord_mode mode);
+  void strip_interior_placement(sub_region* theSub, int col_begin, int col_end,
+                                coord_mode mode, std::vector< cell* >& halo);
+  void group_cell_placement(coord_mode mode);
+  void group_cell_placement(group* theGroup, coord_mode mode);
   void brick_placement_1(group* theGroup);
   void brick_placement_2(group* theGroup);
   int group_refine(group* theGroup);
   int group_annealing(group* theGroup);
   int non_group_annealing();
+  int swap_annealing(const std::vector< cell* >& cell_list, unsigned seed);
   int non_group_refine();
 
+  // cluster.cpp
+  void cluster_placement(CMeasure* measure = nullptr);
+
   // assign.cpp - By SGD
   void fixed_cell_assign();
   void print_pixels();
@@ -550,13 +885,13 @@ class circuit {
 
   // check_legal.cpp - By SGD
   bool check_legality();
+  std::vector< violation > legality_violations();
   void local_density_check(double unit, double target_Ut);
-  void row_check(std::ofstream& os);
-  void site_check(std::ofstream& os);
-  void edge_check(std::ofstream& os);
-  void power_line_check(std::ofstream& os);
-  void placed_check(std::ofstream& log);
-  void overlap_check(std::ofstream& os);
+  void row_check(std::vector< violation >& violations);
+  void site_check(std::vector< violation >& violations);
+  void power_line_check(std::vector< violation >& violations);
+  void placed_check(std::vector< violation >& violations);
+  void overlap_check(std::vector< violation >& violations);
 };
 
 // parser_helper.cpp
@@ -565,6 +900,9 @@ bool read_line_as_tokens(std::istream& is, std::vector< std::string >& tokens);
 void get_next_token(std::ifstream& is, std::string& token, const char* beginComment);
 void get_next_n_tokens(std::ifstream& is, std::vector< std::string >& tokens, const unsigned n,
                        const char* beginComment);
+orient orient_of(const std::string& name);
+const char* orient_name(orient o);
+bool is_gz_file(const std::string& name);
 
 int IntConvert(double fp);
 
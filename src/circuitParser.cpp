@@ -1,5 +1,6 @@
 #include "circuitParser.h"
 #include <cfloat>
+#include <cstdarg>
 
 namespace opendp {
 
@@ -20,8 +21,8 @@ using std::fixed;
 using std::numeric_limits;
 
 // static variable definition
-opendp::macro* CircuitParser::topMacro_ = 0;
-opendp::group* CircuitParser::topGroup_ = 0;
+thread_local opendp::macro* CircuitParser::topMacro_ = 0;
+thread_local opendp::group* CircuitParser::topGroup_ = 0;
 
 CircuitParser::CircuitParser(circuit* ckt )
 : ckt_(ckt) {};
@@ -182,7 +183,7 @@ CircuitParser::LefStartCbk(
   switch(c) {
     case lefrMacroBeginCbkType:
       // Fill topMacro_'s pointer
-      topMacro_ = ckt->locateOrCreateMacro(name);
+      topMacro_ = ckt->locateOrCreateMacro(opendp::name_key(name));
       break;
     default:
       break;
@@ -309,7 +310,8 @@ CircuitParser::LefMacroPinCbk(
     }
   }
  
-  topMacro_->pins[pinName] = myPin;
+  myPin.name = pinName;
+  *topMacro_->locateOrCreatePin(pinName) = myPin;
 
   return 0; 
 }
@@ -432,6 +434,7 @@ int CircuitParser::DefStartCbk(
   switch(c) {
     case defrComponentStartCbkType:
       ckt->cells.reserve(num);
+      ckt->cell_infos.reserve(num);
       break;
     case defrStartPinsCbkType:
       ckt->pins.reserve(num);
@@ -506,7 +509,7 @@ int CircuitParser::DefRowCbk(
   myRow->site = ckt->site2id.at( ro->macro() );
   myRow->origX = ro->x();
   myRow->origY = ro->y();
-  myRow->siteorient = ro->orientStr();
+  myRow->siteorient = static_cast< orient >(ro->orient());
 
 
   if( ro->hasDo() ){
@@ -537,249 +540,328 @@ int CircuitParser::DefRowCbk(
   return 0;
 }
 
-int CircuitParser::DefPinCbk(
-    defrCallbackType_e c, 
-    defiPin* pi,
-    defiUserData ud) {
-  
-  circuit* ckt = (circuit*) ud;
-  pin* myPin = ckt->locateOrCreatePin( pi->pinName() );
+static void CapturePin(defiPin* pi, def_pin_rec& rec) {
+  rec.name = pi->pinName();
+  rec.type = 0;
   if( strcmp(pi->direction(), "INPUT") == 0 ) {
-    myPin -> type = PI_PIN;
+    rec.type = PI_PIN;
   }
   else if( strcmp(pi->direction(), "OUTPUT") == 0 ) {
-    myPin -> type = PO_PIN;
+    rec.type = PO_PIN;
   }
-
-  myPin->isFixed = pi->isFixed();
-
-  // Shift by core.xLL and core.yLL
-  myPin->x_coord = pi->placementX() - ckt->core.xLL;
-  myPin->y_coord = pi->placementY() - ckt->core.yLL;
-
-  return 0;
+  rec.fixed = pi->isFixed();
+  rec.x = pi->placementX();
+  rec.y = pi->placementY();
 }
 
-// DEF's COMPONENT parsing
-int CircuitParser::DefComponentCbk(
-    defrCallbackType_e c,
-    defiComponent* co, 
-    defiUserData ud) {
-
-  circuit* ckt = (circuit*) ud;
-  cell* myCell = NULL;
-  
-
-  // newly inserted cells
-  if( ckt->cell2id.find( co->id() ) == ckt->cell2id.end() ) {
-    myCell = ckt->locateOrCreateCell( co->id() );
-    myCell->type = ckt->macro2id[ co->name() ];
-  }
-  else {
-    myCell = ckt->locateOrCreateCell( co->id() );
+static void ApplyPin(circuit* ckt, const def_pin_rec& rec) {
+  pin* myPin = ckt->locateOrCreatePin( rec.name );
+  if( rec.type != 0 ) {
+    myPin -> type = rec.type;
   }
-   
-//  cout << "co->id: " << co->id() << endl; 
-  macro* myMacro = &ckt->macros[ ckt->macro2id[ co->name() ]];
-  pair<double, double> orientSize 
-    = GetOrientSize( myMacro->width, myMacro->height, co->placementOrient());
 
-  myCell->width = orientSize.first * static_cast<double> (ckt->DEFdist2Microns);
-  myCell->height = orientSize.second * static_cast<double> (ckt->DEFdist2Microns);
+  myPin->isFixed = rec.fixed;
 
-  myCell->isFixed = co->isFixed();
-  
   // Shift by core.xLL and core.yLL
-  myCell->init_x_coord = max(0.0, (co->placementX() - ckt->core.xLL)); 
-  myCell->init_y_coord = max(0.0, (co->placementY() - ckt->core.yLL));
-
-  // fixed cells
-  if( myCell->isFixed ) {
-    // Shift by core.xLL and core.yLL
-    myCell->x_coord = (co->placementX() - ckt->core.xLL);
-    myCell->y_coord = (co->placementY() - ckt->core.yLL);
-    myCell->isPlaced = true;
-  }
-  myCell->cellorient = co->placementOrientStr();
-
-  return 0;
+  myPin->x_coord = rec.x - ckt->core.xLL;
+  myPin->y_coord = rec.y - ckt->core.yLL;
 }
 
-// DEF's COMPONENT parsing
-int CircuitParser::DefComponentWriteCbk(
-    defrCallbackType_e c,
-    defiComponent* co, 
+int CircuitParser::DefPinCbk(
+    defrCallbackType_e c, 
+    defiPin* pi,
     defiUserData ud) {
-
+  
   circuit* ckt = (circuit*) ud;
-  // get FilePointer from ckt class
-  FILE* fout = ckt->fileOut;
-    
-  int i;
-  //  missing GENERATE, FOREIGN
-  fprintf(fout, "- %s %s ", co->id(), co->name());
-  //    co->changeIdAndName("idName", "modelName");
-  //    fprintf(fout, "%s %s ", co->id(),
-  //            co->name());
-  if(co->hasNets()) {
-    for(i = 0; i < co->numNets(); i++) fprintf(fout, "%s ", co->net(i));
-  }
-
-  // get Cell Object
-  cell* theCell = ckt->locateOrCreateCell(co->id());
-  int placeX = IntConvert(theCell->x_coord + ckt->core.xLL);
-  int placeY = IntConvert(theCell->y_coord + ckt->core.yLL);
-  string orientStr = theCell->cellorient;
+  static thread_local def_pin_rec rec;
+  CapturePin(pi, rec);
+  ApplyPin(ckt, rec);
+  return 0;
+}
 
-  if(co->isFixed())
-    fprintf(fout, "+ FIXED ( %d %d ) %s ", 
-        placeX, placeY, orientStr.c_str());
-  if(co->isCover())
-    fprintf(fout, "+ COVER ( %d %d ) %s ", 
-        placeX, placeY, orientStr.c_str());
-  if(co->isPlaced())
-    fprintf(fout, "+ PLACED ( %d %d ) %s ", 
-        placeX, placeY, orientStr.c_str());
-  if(co->isUnplaced()) {
-    fprintf(fout, "+ UNPLACED ");
-    if((placeX != -1) || (placeY != -1)) {
-      fprintf(fout, "( %d %d ) %s ", 
-        placeX, placeY, orientStr.c_str());
-    }
+// printf into a string, for the attribute text kept per component
+static void AppendF(string& s, const char* fmt, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if(len < (int)sizeof(buf)) {
+    s.append(buf, len);
+    return;
   }
-  if(co->hasSource()) fprintf(fout, "+ SOURCE %s ", co->source());
+  vector< char > big(len + 1);
+  va_start(args, fmt);
+  vsnprintf(big.data(), big.size(), fmt, args);
+  va_end(args);
+  s.append(big.data(), len);
+}
+
+// renders everything write_def prints after the placement
+// ( SOURCE .. PROPERTY ), usually nothing for standard cells
+static void AppendComponentExtra(string& s, defiComponent* co) {
+  int i;
+  if(co->hasSource()) AppendF(s, "+ SOURCE %s ", co->source());
   if(co->hasGenerate()) {
-    fprintf(fout, "+ GENERATE %s ", co->generateName());
+    AppendF(s, "+ GENERATE %s ", co->generateName());
     if(co->macroName() && *(co->macroName()))
-      fprintf(fout, "%s ", co->macroName());
+      AppendF(s, "%s ", co->macroName());
   }
-  if(co->hasWeight()) fprintf(fout, "+ WEIGHT %d ", co->weight());
-  if(co->hasEEQ()) fprintf(fout, "+ EEQMASTER %s ", co->EEQ());
-  if(co->hasRegionName()) fprintf(fout, "+ REGION %s ", co->regionName());
+  if(co->hasWeight()) AppendF(s, "+ WEIGHT %d ", co->weight());
+  if(co->hasEEQ()) AppendF(s, "+ EEQMASTER %s ", co->EEQ());
+  if(co->hasRegionName()) AppendF(s, "+ REGION %s ", co->regionName());
   if(co->hasRegionBounds()) {
     int *xl, *yl, *xh, *yh;
     int size;
     co->regionBounds(&size, &xl, &yl, &xh, &yh);
     for(i = 0; i < size; i++) {
-      fprintf(fout, "+ REGION %d %d %d %d \n", xl[i], yl[i], xh[i], yh[i]);
+      AppendF(s, "+ REGION %d %d %d %d \n", xl[i], yl[i], xh[i], yh[i]);
     }
   }
   if(co->maskShiftSize()) {
-    fprintf(fout, "+ MASKSHIFT ");
+    s += "+ MASKSHIFT ";
 
     for(int i = co->maskShiftSize() - 1; i >= 0; i--) {
-      fprintf(fout, "%d", co->maskShift(i));
+      AppendF(s, "%d", co->maskShift(i));
     }
-    fprintf(fout, "\n");
+    s += "\n";
   }
   if(co->hasHalo()) {
     int left, bottom, right, top;
     (void)co->haloEdges(&left, &bottom, &right, &top);
-    fprintf(fout, "+ HALO ");
-    if(co->hasHaloSoft()) fprintf(fout, "SOFT ");
-    fprintf(fout, "%d %d %d %d\n", left, bottom, right, top);
+    s += "+ HALO ";
+    if(co->hasHaloSoft()) s += "SOFT ";
+    AppendF(s, "%d %d %d %d\n", left, bottom, right, top);
   }
   if(co->hasRouteHalo()) {
-    fprintf(fout, "+ ROUTEHALO %d %s %s\n", co->haloDist(), co->minLayer(),
-        co->maxLayer());
+    AppendF(s, "+ ROUTEHALO %d %s %s\n", co->haloDist(), co->minLayer(),
+            co->maxLayer());
   }
   if(co->hasForeignName()) {
-    fprintf(fout, "+ FOREIGN %s %d %d %s %d ", co->foreignName(),
-        co->foreignX(), co->foreignY(), co->foreignOri(),
-        co->foreignOrient());
+    AppendF(s, "+ FOREIGN %s %d %d %s %d ", co->foreignName(),
+            co->foreignX(), co->foreignY(), co->foreignOri(),
+            co->foreignOrient());
   }
   if(co->numProps()) {
     for(i = 0; i < co->numProps(); i++) {
-      fprintf(fout, "+ PROPERTY %s %s ", co->propName(i), co->propValue(i));
+      AppendF(s, "+ PROPERTY %s %s ", co->propName(i), co->propValue(i));
       switch(co->propType(i)) {
         case 'R':
-          fprintf(fout, "REAL ");
+          s += "REAL ";
           break;
         case 'I':
-          fprintf(fout, "INTEGER ");
+          s += "INTEGER ";
           break;
         case 'S':
-          fprintf(fout, "STRING ");
+          s += "STRING ";
           break;
         case 'Q':
-          fprintf(fout, "QUOTESTRING ");
+          s += "QUOTESTRING ";
           break;
         case 'N':
-          fprintf(fout, "NUMBER ");
+          s += "NUMBER ";
           break;
       }
     }
   }
-  fprintf(fout, ";\n");
+}
 
-  return 0;
+static void CaptureComponent(defiComponent* co, def_component_rec& rec) {
+  rec.name = co->id();
+  rec.macro = co->name();
+  rec.x = co->placementX();
+  rec.y = co->placementY();
+  rec.orient = co->placementOrient();
+  rec.fixed = co->isFixed();
+  if(co->isFixed())
+    rec.status = DEF_FIXED;
+  else if(co->isCover())
+    rec.status = DEF_COVER;
+  else if(co->isPlaced())
+    rec.status = DEF_PLACED;
+  else if(co->isUnplaced())
+    rec.status = DEF_UNPLACED;
+  else
+    rec.status = DEF_NO_STATUS;
+  rec.text.clear();
+  if(co->hasNets()) {
+    for(int i = 0; i < co->numNets(); i++) {
+      AppendF(rec.text, "%s ", co->net(i));
+    }
+  }
+  rec.nets_len = rec.text.size();
+  AppendComponentExtra(rec.text, co);
 }
 
-// DEF's NET
-int CircuitParser::DefNetCbk(
+static void ApplyComponent(circuit* ckt, const def_component_rec& rec) {
+  cell* myCell = NULL;
+
+  unsigned macroId = opendp::find_id(ckt->macro2id, opendp::name_key(rec.macro));
+  if( macroId == UINT_MAX ) {
+    cout << "ERROR: COMPONENT " << rec.name << " uses MACRO " << rec.macro
+      << " which is not defined in LEF" << endl;
+    exit(1);
+  }
+
+  // newly inserted cells
+  size_t numCells = ckt->cells.size();
+  myCell = ckt->locateOrCreateCell( opendp::name_key(rec.name) );
+  if( ckt->cells.size() != numCells ) {
+    myCell->type = macroId;
+  }
+   
+  macro* myMacro = &ckt->macros[ macroId ];
+  pair<double, double> orientSize 
+    = GetOrientSize( myMacro->width, myMacro->height, rec.orient);
+
+  myCell->width = orientSize.first * static_cast<double> (ckt->DEFdist2Microns);
+  myCell->height = orientSize.second * static_cast<double> (ckt->DEFdist2Microns);
+
+  myCell->isFixed = rec.fixed;
+  
+  // Shift by core.xLL and core.yLL
+  myCell->init_x_coord = max(0.0, (rec.x - ckt->core.xLL)); 
+  myCell->init_y_coord = max(0.0, (rec.y - ckt->core.yLL));
+
+  // fixed cells
+  if( myCell->isFixed ) {
+    // Shift by core.xLL and core.yLL
+    myCell->x_coord = (rec.x - ckt->core.xLL);
+    myCell->y_coord = (rec.y - ckt->core.yLL);
+    myCell->isPlaced = true;
+  }
+  myCell->cellorient = static_cast< orient >(rec.orient);
+
+  // write_def regenerates this statement from the cell and these leftovers
+  def_component comp;
+  comp.cell = myCell->id;
+  comp.status = rec.status;
+  comp.text = ckt->def_component_text.size();
+  comp.nets_len = rec.nets_len;
+  comp.extra_len = rec.text.size() - rec.nets_len;
+  ckt->def_component_text += rec.text;
+  ckt->def_components.push_back(comp);
+}
+
+// DEF's COMPONENT parsing
+int CircuitParser::DefComponentCbk(
     defrCallbackType_e c,
-    defiNet* dnet, 
+    defiComponent* co, 
     defiUserData ud) {
-  circuit* ckt = (circuit*) ud;
-  net* myNet = NULL;
 
-  myNet = ckt->locateOrCreateNet( dnet->name() );
-  unsigned myNetId = ckt->net2id.find(myNet->name)->second;
+  circuit* ckt = (circuit*) ud;
+  static thread_local def_component_rec rec;
+  CaptureComponent(co, rec);
+  ApplyComponent(ckt, rec);
+  return 0;
+}
 
-  // subNet iterations
+static void CaptureNet(defiNet* dnet, def_net_rec& rec) {
+  rec.name = dnet->name();
+  rec.conns.resize(dnet->numConnections());
   for(int i=0; i<dnet->numConnections(); i++) {
-    // Extract pin informations
-    string pinName = (strcmp(dnet->instance(i), "PIN") == 0)? 
-      dnet->pin(i) : 
-      string(dnet->instance(i)) + ":" + string(dnet->pin(i));
+    rec.conns[i].first = dnet->instance(i);
+    rec.conns[i].second = dnet->pin(i);
+  }
+}
 
-    pin* myPin = ckt->locateOrCreatePin( pinName );
-    myPin->net = myNetId;
+static void ApplyNet(circuit* ckt, const def_net_rec& rec) {
+  net* myNet = NULL;
 
-    // source setting
-    if( i == 0 ) {
-      myNet->source = myPin->id; 
-    }
+  myNet = ckt->locateOrCreateNet( opendp::name_key(rec.name) );
+  unsigned myNetId = myNet - &ckt->nets[0];
 
-    // if it is cell inst's pin (e.g. not equal to "PIN")
-    // Fill owner's info
-    if( strcmp(dnet->instance(i), "PIN") != 0 ) {
-      myPin->owner = ckt->cell2id[ dnet->instance(i) ];
-      myPin->type = NONPIO_PIN;
-
-//      cout << "owner's name: " << dnet->instance(i) << endl;
-//      cout << "owner: " << myPin->owner << endl;
-//      cout << "type: " << ckt->cells[myPin->owner].type << endl; 
-      macro* theMacro = &ckt->macros[ ckt->cells[myPin->owner].type ];
-//      cout << "theMacro: " << theMacro << endl;
-//      cout << "theMacro pin size: " << theMacro->pins.size() << endl;
-//      cout << "dnet->pin: " << dnet->pin(i) << endl;
-      macro_pin* myMacroPin = &theMacro->pins[ dnet->pin(i) ];
-//      cout << "myMacroPin: " << myMacroPin << endl;
-//      cout << "port: " << myMacroPin->port.size() << endl;
-
-      if( myMacroPin-> port.size() == 0 ) {
-        cout << "ERROR: in Net " << dnet->name() 
-          << " has a module:pin definition as " << pinName 
+  // subNet iterations
+  for(size_t i=0; i<rec.conns.size(); i++) {
+    const string& instance = rec.conns[i].first;
+    const string& pinName = rec.conns[i].second;
+    // Extract pin informations : PI/PO by name, cell pins by ( cell, macro pin )
+    pin* myPin = NULL;
+    if( instance == "PIN" ) {
+      myPin = ckt->locateOrCreatePin( pinName );
+    }
+    else {
+      unsigned cellId = 
+        opendp::find_id(ckt->cell2id, opendp::name_key(instance));
+      if( cellId == UINT_MAX ) {
+        cout << "ERROR: in Net " << rec.name << " has an unknown COMPONENT "
+          << instance << endl;
+        exit(1);
+      }
+      macro* theMacro = &ckt->macros[ ckt->cells[cellId].type ];
+      int macroPin = theMacro->find_pin( pinName.c_str() );
+      if( macroPin < 0 || theMacro->pins[macroPin].port.size() == 0 ) {
+        cout << "ERROR: in Net " << rec.name 
+          << " has a module:pin definition as " << instance
+          << ":" << pinName 
           << " but there is no PORT/PIN definition in LEF MACRO: " 
           << theMacro->name << endl;
         exit(1);
       }
-      myPin->x_offset = 
-        myMacroPin->port[0].xLL / 2 + myMacroPin->port[0].xUR / 2;
-      myPin->y_offset = 
-        myMacroPin->port[0].yLL / 2 + myMacroPin->port[0].yUR / 2;
-//      cout << "calculated x_offset: " << myPin->x_offset << endl;
-//      cout << "calculated y_offset: " << myPin->y_offset << endl;
+      myPin = ckt->locateOrCreateCellPin( cellId, macroPin );
+    }
+    myPin->net = myNetId;
+
+    // source setting
+    if( i == 0 ) {
+      myNet->source = myPin->id; 
     }
 
     if( i != 0 ){
       myNet->sinks.push_back(myPin->id);
     }
   }
+}
+
+// DEF's NET
+int CircuitParser::DefNetCbk(
+    defrCallbackType_e c,
+    defiNet* dnet, 
+    defiUserData ud) {
+  circuit* ckt = (circuit*) ud;
+  static thread_local def_net_rec rec;
+  CaptureNet(dnet, rec);
+  ApplyNet(ckt, rec);
   return 0;
 }
 
+int CircuitParser::DefComponentRecCbk(
+    defrCallbackType_e c,
+    defiComponent* co,
+    defiUserData ud) {
+  def_records* recs = (def_records*) ud;
+  recs->comps.emplace_back();
+  CaptureComponent(co, recs->comps.back());
+  return 0;
+}
+
+int CircuitParser::DefPinRecCbk(
+    defrCallbackType_e c,
+    defiPin* pi,
+    defiUserData ud) {
+  def_records* recs = (def_records*) ud;
+  recs->pins.emplace_back();
+  CapturePin(pi, recs->pins.back());
+  return 0;
+}
+
+int CircuitParser::DefNetRecCbk(
+    defrCallbackType_e c,
+    defiNet* dnet,
+    defiUserData ud) {
+  def_records* recs = (def_records*) ud;
+  recs->nets.emplace_back();
+  CaptureNet(dnet, recs->nets.back());
+  return 0;
+}
+
+// replays records captured by the Rec callbacks, in their order
+void CircuitParser::ApplyRecords(circuit* ckt, const def_records& recs) {
+  for(auto& rec : recs.comps) ApplyComponent(ckt, rec);
+  for(auto& rec : recs.pins) ApplyPin(ckt, rec);
+  for(auto& rec : recs.nets) ApplyNet(ckt, rec);
+}
+
 // DEF's SPECIALNETS
 // Extract VDD/VSS row informations for mixed-height legalization
 int CircuitParser::DefSNetCbk(
@@ -904,18 +986,7 @@ int CircuitParser::DefGroupMemberCbk(
   circuit* ckt = (circuit*) ud;
 
   topGroup_->tag = name;
-  for(auto& curCell : ckt->cells) {
-    // HARD CODE
-    // Suppose tag is always SOMETH/*
-    // need to port regexp lib later
-    if(strncmp(topGroup_->tag.c_str(), curCell.name.c_str(),
-          topGroup_->tag.size() - 1) == 0) {
-      topGroup_->siblings.push_back(&curCell);
-      curCell.group = topGroup_->name;
-      curCell.inGroup = true;
-    }
-  } 
-
+  ckt->add_group_members(topGroup_, topGroup_->tag);
   return 0;
 }
 
@@ -944,7 +1015,7 @@ vector<opendp::row> GetNewRow(const circuit* ckt) {
   int rowCntY = IntConvert((ckt->core.yUR - ckt->core.yLL)/ckt->rowHeight);
 
   unsigned siteIdx = ckt->prevrows[0].site;
-  string curOrient = ckt->prevrows[0].siteorient;
+  orient curOrient = ckt->prevrows[0].siteorient;
 
   for(int i=0; i<rowCntY; i++) {
     opendp::row myRow;
@@ -960,7 +1031,7 @@ vector<opendp::row> GetNewRow(const circuit* ckt) {
     retRow.push_back(myRow);
 
     // curOrient is flipping. e.g. N -> FS -> N -> FS -> ...
-    curOrient = (curOrient == "N")? "FS" : "N";
+    curOrient = (curOrient == ORIENT_N)? ORIENT_FS : ORIENT_N;
   }
   return retRow;
 }
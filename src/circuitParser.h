@@ -12,11 +12,43 @@
 
 namespace opendp {
 
+// COMPONENTS / PINS / NETS records copied out of the DEF reader. ReadDef
+// parses chunks of those sections on several threads into def_records
+// and replays them in file order, so ids come out as in a serial read.
+struct def_component_rec {
+  std::string name;
+  std::string macro;
+  double x, y;
+  int orient;
+  bool fixed;
+  def_status status;
+  std::string text;  /* nets, then the attributes after the placement */
+  unsigned nets_len;
+};
+
+struct def_pin_rec {
+  std::string name;
+  unsigned type; /* PI_PIN, PO_PIN or 0 to leave as is */
+  bool fixed;
+  double x, y;
+};
+
+struct def_net_rec {
+  std::string name;
+  std::vector< std::pair< std::string, std::string > > conns; /* instance, pin */
+};
+
+struct def_records {
+  std::vector< def_component_rec > comps;
+  std::vector< def_pin_rec > pins;
+  std::vector< def_net_rec > nets;
+};
+
 class CircuitParser {
 protected:
   opendp::circuit* ckt_;
-  static opendp::macro* topMacro_;
-  static opendp::group* topGroup_;
+  static thread_local opendp::macro* topMacro_;
+  static thread_local opendp::group* topGroup_;
 
 public:
 	CircuitParser(opendp::circuit* ckt_);
@@ -52,10 +84,11 @@ public:
   static int DefGroupNameCbk(defrCallbackType_e c, const char* name, defiUserData ud);
   static int DefGroupMemberCbk(defrCallbackType_e c, const char* name, defiUserData ud);
 
-
-  // DEF writing function
-  static int DefComponentWriteCbk(defrCallbackType_e c, defiComponent* co, defiUserData ud);
-
+  // record capture for parallel reads, ud is a def_records*
+  static int DefComponentRecCbk(defrCallbackType_e c, defiComponent* co, defiUserData ud);
+  static int DefPinRecCbk(defrCallbackType_e c, defiPin* pi, defiUserData ud);
+  static int DefNetRecCbk(defrCallbackType_e c, defiNet* net, defiUserData ud);
+  static void ApplyRecords(opendp::circuit* ckt, const def_records& recs);
 };
 }
 
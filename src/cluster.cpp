@@ -0,0 +1,331 @@
+/////////////////////////////////////////////////////////////////////////////
+// Authors: SangGi Do(sanggido@unist.ac.kr), Mingyu Woo(mwoo@eng.ucsd.edu)
+//          (respective Ph.D. advisors: Seokhyeong Kang, Andrew B. Kahng)
+//
+//          Original parsing structure was made by Myung-Chul Kim (IBM).
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, SangGi Do and Mingyu Woo
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "circuit.h"
+
+// Cluster legalizer ( Abacus ) : an alternative to the pixel diamond search.
+//
+// Multi-deck cells are placed first by map_move, which keeps them on rows of
+// the right power parity. The free gaps left in each row then become the
+// row segments, one list per group plus one for cells out of groups. Single
+// row cells are visited in target x order; each goes to the row and segment
+// where appending it costs the least displacement. Inside a segment cells
+// are packed into clusters whose left edge minimizes the squared distance
+// of its cells to their targets, merging with the left neighbour on overlap.
+
+using opendp::circuit;
+using opendp::cell;
+using opendp::macro;
+using opendp::group;
+using opendp::rect;
+using opendp::free_gap;
+
+using std::cout;
+using std::endl;
+using std::vector;
+using std::pair;
+using std::make_pair;
+using std::sort;
+using std::min;
+using std::max;
+
+// cells [first, last] of a segment, abutted from site x
+struct abacus_cluster {
+  int first;
+  int last;
+  double e; /* number of cells */
+  double q; /* sum of ( target - offset in cluster ) */
+  int w;    /* width in sites */
+  double x;
+};
+
+// free sites [start, end) of one row
+struct abacus_segment {
+  int start;
+  int end;
+  int used; /* sites taken by cells so far */
+  vector< cell* > cells;
+  vector< int > widths; /* sites incl. edge spacing */
+  vector< abacus_cluster > clusters;
+};
+
+static inline double clamp_x(double x, int start, int end, int w) {
+  return min(max(x, (double)start), (double)(end - w));
+}
+
+// left site the cell of width w aimed at site x would get when appended
+static double abacus_trial(const abacus_segment& seg, double x, int w) {
+  double e = 1.0;
+  double q = x;
+  int wc = w;
+  double cx = clamp_x(q / e, seg.start, seg.end, wc);
+  for(int k = (int)seg.clusters.size() - 1; k >= 0; k--) {
+    const abacus_cluster& prev = seg.clusters[k];
+    if(prev.x + prev.w <= cx) break;
+    q = prev.q + q - e * prev.w;
+    e += prev.e;
+    wc += prev.w;
+    cx = clamp_x(q / e, seg.start, seg.end, wc);
+  }
+  return cx + wc - w;
+}
+
+static void abacus_append(abacus_segment& seg, cell* theCell, double x,
+                          int w) {
+  abacus_cluster c;
+  c.first = c.last = seg.cells.size();
+  c.e = 1.0;
+  c.q = x;
+  c.w = w;
+  c.x = clamp_x(x, seg.start, seg.end, w);
+  seg.cells.push_back(theCell);
+  seg.widths.push_back(w);
+  seg.used += w;
+  seg.clusters.push_back(c);
+
+  while(seg.clusters.size() > 1) {
+    abacus_cluster& last = seg.clusters.back();
+    abacus_cluster& prev = seg.clusters[seg.clusters.size() - 2];
+    if(prev.x + prev.w <= last.x) break;
+    prev.q += last.q - last.e * prev.w;
+    prev.e += last.e;
+    prev.w += last.w;
+    prev.last = last.last;
+    prev.x = clamp_x(prev.q / prev.e, seg.start, seg.end, prev.w);
+    seg.clusters.pop_back();
+  }
+  return;
+}
+
+void circuit::cluster_placement(CMeasure* measure) {
+  // multi-deck cells by the pixel engine
+  vector< cell* > cell_list;
+  cell_list.reserve(cells.size());
+  for(int i = 0; i < cells.size(); i++) {
+    cell* theCell = &cells[i];
+    if(theCell->isFixed || theCell->isPlaced) continue;
+    if(macros[theCell->type].isMulti == false) continue;
+    cell_list.push_back(theCell);
+  }
+  sort(cell_list.begin(), cell_list.end(), [](cell* a, cell* b) {
+    if(a->width * a->height != b->width * b->height)
+      return a->width * a->height > b->width * b->height;
+    return a->id < b->id;
+  });
+  for(int i = 0; i < cell_list.size(); i++) {
+    cell* theCell = cell_list[i];
+    if(map_move(theCell, MODE_INIT_COORD) == false)
+      shift_move(theCell, MODE_INIT_COORD);
+  }
+  cout << " cluster_placement multi-deck done .. ( " << cell_list.size()
+       << " cells )" << endl;
+  if(measure) {
+    measure->stop_clock("cluster multi-deck placement");
+  }
+
+  // row segments : segs[y * bucket_num + group], group == groups.size() for
+  // cells out of groups
+  int row_num = grid.row_num;
+  int bucket_num = groups.size() + 1;
+  vector< vector< abacus_segment > > segs(row_num * bucket_num);
+  for(int y = 0; y < row_num; y++) {
+    for(int g = 0; g < bucket_num; g++) {
+      unsigned short key = (g == groups.size()) ? PIXEL_NO_GROUP : g;
+      if(key != PIXEL_NO_GROUP && key >= grid.group_num) continue;
+      const vector< free_gap >& gaps = grid.row_gaps(y, 0, key);
+      vector< abacus_segment >& row_segs = segs[y * bucket_num + g];
+      for(int k = 0; k < gaps.size(); k++) {
+        if(gaps[k].group != key) continue;
+        abacus_segment seg;
+        seg.start = gaps[k].start;
+        seg.end = gaps[k].end;
+        seg.used = 0;
+        row_segs.push_back(seg);
+      }
+    }
+  }
+
+  // single row cells in target x order; group cells out of their fence aim
+  // at its nearest region
+  vector< pair< pair< int, int >, cell* > > targets;
+  targets.reserve(cells.size());
+  for(int i = 0; i < cells.size(); i++) {
+    cell* theCell = &cells[i];
+    if(theCell->isFixed || theCell->isPlaced) continue;
+    pair< int, int > coord =
+        make_pair(theCell->init_x_coord, theCell->init_y_coord);
+    if(theCell->inGroup) {
+      group* theGroup = &groups[theCell->group];
+      int dist = INT_MAX;
+      bool inside = false;
+      rect* target = NULL;
+      for(int k = 0; k < theGroup->regions.size(); k++) {
+        rect* theRect = &theGroup->regions[k];
+        if(check_inside(theCell, theRect, MODE_INIT_COORD) == true)
+          inside = true;
+        int temp_dist = dist_for_rect(theCell, theRect, MODE_INIT_COORD);
+        if(temp_dist < dist) {
+          dist = temp_dist;
+          target = theRect;
+        }
+      }
+      if(inside == false && target != NULL)
+        coord = nearest_coord_to_rect_boundary(theCell, target,
+                                               MODE_INIT_COORD);
+    }
+    targets.push_back(make_pair(coord, theCell));
+  }
+  sort(targets.begin(), targets.end(),
+       [](const pair< pair< int, int >, cell* >& a,
+          const pair< pair< int, int >, cell* >& b) {
+         if(a.first.first != b.first.first)
+           return a.first.first < b.first.first;
+         return a.second->id < b.second->id;
+       });
+
+  vector< cell* > unplaced;
+  for(int i = 0; i < targets.size(); i++) {
+    cell* theCell = targets[i].second;
+    int x_coord = targets[i].first.first;
+    int y_coord = targets[i].first.second;
+    macro* theMacro = &macros[theCell->type];
+
+    // edge spacing as bin_search reserves it
+    int edge_left = (theMacro->edgetypeLeft == 1) ? 2 : 0;
+    int edge_right = (theMacro->edgetypeRight == 1) ? 2 : 0;
+    int w = (int)ceil(theCell->width / wsite) + edge_left + edge_right;
+    int g = theCell->inGroup ? theCell->group : groups.size();
+    double x = x_coord / wsite - edge_left;
+    int y_center =
+        max(0, min(row_num - 1, (int)floor(y_coord / rowHeight + 0.5)));
+
+    // rows outward from y_center until the row distance alone loses
+    double best_cost = DBL_MAX;
+    int best_y = -1;
+    int best_seg = -1;
+    for(int d = 0; y_center - d >= 0 || y_center + d < row_num; d++) {
+      bool in_reach = false;
+      for(int side = 0; side < 2; side++) {
+        if(d == 0 && side == 1) break;
+        int y = (side == 0) ? y_center + d : y_center - d;
+        if(y < 0 || y >= row_num) continue;
+        double y_cost = fabs(y_coord - y * rowHeight);
+        if(y_cost >= best_cost) continue;
+        in_reach = true;
+
+        vector< abacus_segment >& row_segs = segs[y * bucket_num + g];
+        // first segment starting right of x, then walk both ways
+        int lo = 0;
+        int hi = row_segs.size();
+        while(lo < hi) {
+          int mid = (lo + hi) / 2;
+          if(row_segs[mid].start <= x)
+            lo = mid + 1;
+          else
+            hi = mid;
+        }
+        for(int dir = 0; dir < 2; dir++) {
+          for(int k = (dir == 0) ? lo - 1 : lo;
+              k >= 0 && k < row_segs.size(); k += (dir == 0) ? -1 : 1) {
+            abacus_segment& seg = row_segs[k];
+            double gap = 0.0;
+            if(x < seg.start)
+              gap = seg.start - x;
+            else if(x > seg.end - w)
+              gap = x - (seg.end - w);
+            if(gap * wsite + y_cost >= best_cost) break;
+            if(seg.end - seg.start - seg.used < w) continue;
+            double pos = abacus_trial(seg, x, w);
+            double cost = fabs(pos - x) * wsite + y_cost;
+            if(cost < best_cost) {
+              best_cost = cost;
+              best_y = y;
+              best_seg = k;
+            }
+          }
+        }
+      }
+      if(in_reach == false && d > 0 && best_cost != DBL_MAX) break;
+    }
+
+    if(best_seg < 0) {
+      unplaced.push_back(theCell);
+      continue;
+    }
+    abacus_append(segs[best_y * bucket_num + g][best_seg], theCell, x, w);
+  }
+
+  // abut each cluster from its rounded site; rounding keeps the order
+  int count = 0;
+  for(int y = 0; y < row_num; y++) {
+    for(int g = 0; g < bucket_num; g++) {
+      vector< abacus_segment >& row_segs = segs[y * bucket_num + g];
+      for(int k = 0; k < row_segs.size(); k++) {
+        abacus_segment& seg = row_segs[k];
+        for(int c = 0; c < seg.clusters.size(); c++) {
+          abacus_cluster& theCluster = seg.clusters[c];
+          int x = (int)floor(theCluster.x + 0.5);
+          x = min(max(x, seg.start), seg.end - theCluster.w);
+          for(int j = theCluster.first; j <= theCluster.last; j++) {
+            cell* theCell = seg.cells[j];
+            macro* theMacro = &macros[theCell->type];
+            int edge_left = (theMacro->edgetypeLeft == 1) ? 2 : 0;
+            paint_pixel(theCell, x + edge_left, y);
+            x += seg.widths[j];
+            count++;
+          }
+        }
+      }
+    }
+  }
+  cout << " cluster_placement single-deck done .. ( " << count << " cells )"
+       << endl;
+
+  // no segment had room within reach
+  for(int i = 0; i < unplaced.size(); i++) {
+    cell* theCell = unplaced[i];
+    if(map_move(theCell, MODE_INIT_COORD) == false)
+      shift_move(theCell, MODE_INIT_COORD);
+  }
+  if(unplaced.size() > 0)
+    cout << " cluster_placement fallback .. ( " << unplaced.size()
+         << " cells )" << endl;
+  if(measure) {
+    measure->stop_clock("cluster single-deck placement");
+  }
+  return;
+}
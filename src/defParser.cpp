@@ -32,10 +32,15 @@
 #include <string.h>
 #include <time.h>
 #ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif /* not WIN32 */
 #include "defrReader.hpp"
 #include "defiAlias.hpp"
+#include "defzlib.hpp"
+#include "zlib.h"
 #include "circuit.h"
 #include "circuitParser.h"
 
@@ -57,18 +62,19 @@ using std::vector;
 using std::make_pair;
 using std::to_string;
 using std::string;
-
-// Global variables
-static FILE* fout;
-static void* userData;
-static int numObjs;
-static int isSumSet;    // to keep track if within SUM
-static int isProp = 0;  // for PROPERTYDEFINITIONS
-static int begOperand;  // to keep track for constraint, to print - as the 1st char
-static double curVer = 0;
-static int ignoreRowNames = 0;
-static int ignoreViaNames = 0;
-static int testDebugPrint = 0;  // test for ccr1488696
+using std::sort;
+
+// Parser state, one copy per thread so designs can be read concurrently
+static thread_local FILE* fout;
+static thread_local void* userData;
+static thread_local int numObjs;
+static thread_local int isSumSet;    // to keep track if within SUM
+static thread_local int isProp = 0;  // for PROPERTYDEFINITIONS
+static thread_local int begOperand;  // to keep track for constraint, to print - as the 1st char
+static thread_local double curVer = 0;
+static thread_local int ignoreRowNames = 0;
+static thread_local int ignoreViaNames = 0;
+static thread_local int testDebugPrint = 0;  // test for ccr1488696
 
 // TX_DIR:TRANSLATION ON
 
@@ -80,6 +86,8 @@ static void myWarningLogFunction(const char* errMsg) {
   fprintf(fout, "WARNING: found error: %s\n", errMsg);
 }
 
+static void printWarning(const char* str) { fprintf(stderr, "%s\n", str); }
+
 static void dataError() {
   fprintf(fout, "ERROR: returned user data is not correct!\n");
 }
@@ -106,6 +114,415 @@ int endfunc(defrCallbackType_e c, void*, defiUserData ud) {
   return 0;
 }
 
+// Finds the COMPONENTS, PINS and NETS bodies while the parser pulls bytes,
+// so write_def can copy the rest of the input without reading it again
+// and ReadDef can hand the records to several threads. Matches lines that
+// start with the section keyword / "END <section>".
+// With skip_nets the NETS statement is also cut out of what the parser
+// sees; its range and the header before the first section are recorded
+// for ReadDefNets.
+static thread_local struct {
+  long long pos;        /* input bytes consumed so far */
+  long long line_begin; /* offset of the current line */
+  char head[14];        /* first bytes of the current line */
+  int head_len;
+  bool head_done;
+  int after_head;   /* current line follows this section's header, or -1 */
+  bool gz;          /* file is a defGZFile */
+  bool skip_nets;
+  bool in_nets;   /* dropping lines of the NETS statement */
+  bool after_nets; /* current line is END NETS */
+  bool drop;      /* current line is not passed on */
+  bool record_only; /* only offsets; the parser reads the file itself */
+  bool eof;
+  long long body[3][2]; /* COMPONENTS, PINS, NETS records, without header/END */
+  long long prelude_end;
+  long long nets_begin;
+  long long nets_end;
+  vector< char > raw;
+  string out; /* kept bytes not yet handed to the parser */
+  size_t out_pos;
+  const char* map; /* the file, kept mapped by defScanMapped */
+  long long map_len;
+} defScan;
+
+static const char* defBodyWords[3] = {"COMPONENTS", "PINS", "NETS"};
+static const char* defBodyEnds[3] = {"END COMPONENTS", "END PINS",
+                                     "END NETS"};
+
+// section keywords ending the header; longer ones are not needed since
+// a section always precedes them
+static const char* defSectionWords[] = {
+    "DIEAREA", "ROW",        "TRACKS",      "GCELLGRID", "VIAS",
+    "STYLES",  "COMPONENTS", "PINS",        "PINPROPERTIES",
+    "BLOCKAGES", "SLOTS",    "FILLS",       "SPECIALNETS", "NETS",
+    "SCANCHAINS", "GROUPS",  "REGIONS",     "BEGINEXT"};
+
+static bool defScanWord(const char* word) {
+  int len = strlen(word);
+  return defScan.head_len >= len && strncmp(defScan.head, word, len) == 0 &&
+         (defScan.head_len == len || isspace(defScan.head[len]));
+}
+
+static void defScanHead() {
+  if(defScan.prelude_end < 0) {
+    for(const char* word : defSectionWords) {
+      if(defScanWord(word)) {
+        defScan.prelude_end = defScan.line_begin;
+        break;
+      }
+    }
+  }
+  for(int s = 0; s < 3; s++) {
+    if(defScan.body[s][0] < 0) {
+      if(defScanWord(defBodyWords[s])) defScan.after_head = s;
+    }
+    else if(defScan.body[s][1] < 0 && defScanWord(defBodyEnds[s])) {
+      defScan.body[s][1] = defScan.line_begin;
+    }
+  }
+
+  if(defScan.skip_nets) {
+    if(defScan.nets_begin < 0 && defScanWord("NETS")) {
+      defScan.nets_begin = defScan.line_begin;
+      defScan.in_nets = true;
+    }
+    else if(defScan.in_nets && defScanWord("END NETS")) {
+      defScan.after_nets = true;
+    }
+  }
+  defScan.drop = defScan.in_nets;
+}
+
+// splits raw input into lines, appending the kept ones to defScan.out
+static void defScanChunk(const char* buf, size_t nb) {
+  const char* p = buf;
+  const char* end = buf + nb;
+  while(p < end) {
+    if(!defScan.head_done) {
+      while(p < end && defScan.head_len < 14 && *p != '\n') {
+        defScan.head[defScan.head_len++] = *p++;
+      }
+      if(p == end && defScan.head_len < 14) break;
+      defScanHead();
+      defScan.head_done = true;
+      if(!defScan.drop && !defScan.record_only)
+        defScan.out.append(defScan.head, defScan.head_len);
+    }
+    const char* nl = (const char*)memchr(p, '\n', end - p);
+    const char* stop = (nl == NULL) ? end : nl + 1;
+    if(!defScan.drop && !defScan.record_only) defScan.out.append(p, stop - p);
+    p = stop;
+    if(nl == NULL) break;
+    defScan.line_begin = defScan.pos + (p - buf);
+    if(defScan.after_head >= 0) {
+      defScan.body[defScan.after_head][0] = defScan.line_begin;
+      defScan.after_head = -1;
+    }
+    if(defScan.after_nets) {
+      defScan.nets_end = defScan.line_begin;
+      defScan.after_nets = defScan.in_nets = false;
+    }
+    defScan.head_len = 0;
+    defScan.head_done = false;
+  }
+  defScan.pos += nb;
+}
+
+static void defScanEnd() {
+  // last line without a newline
+  defScan.eof = true;
+  if(!defScan.head_done) {
+    defScanHead();
+    if(!defScan.drop && !defScan.record_only)
+      defScan.out.append(defScan.head, defScan.head_len);
+  }
+  if(defScan.in_nets && defScan.after_nets) defScan.nets_end = defScan.pos;
+}
+
+// Records the offsets of a plain DEF in one pass over a mapping of it, so
+// defrRead can map and tokenize the file in place instead of pulling it
+// through defScanRead. Nothing is cut, so this is only for !skip_nets.
+// The mapping stays in defScan.map until ReadDef is done with it.
+static bool defScanMapped(const char* name) {
+#ifndef WIN32
+  int fd = ::open(name, O_RDONLY);
+  if(fd < 0) return false;
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if(addr == MAP_FAILED) return false;
+#ifdef MADV_SEQUENTIAL
+  madvise(addr, st.st_size, MADV_SEQUENTIAL);
+#endif
+  defScan.record_only = true;
+  defScanChunk((const char*)addr, st.st_size);
+  defScanEnd();
+  defScan.map = (const char*)addr;
+  defScan.map_len = st.st_size;
+  return true;
+#else
+  return false;
+#endif
+}
+
+static size_t defScanRead(FILE* file, char* buf, size_t len) {
+  while(defScan.out.size() - defScan.out_pos < len && !defScan.eof) {
+    if(defScan.out_pos > 0) {
+      defScan.out.erase(0, defScan.out_pos);
+      defScan.out_pos = 0;
+    }
+    size_t nb = 0;
+    if(defScan.gz) {
+      int z = gzread((gzFile)file, defScan.raw.data(), defScan.raw.size());
+      nb = (z > 0) ? z : 0;
+    }
+    else
+      nb = fread(defScan.raw.data(), 1, defScan.raw.size(), file);
+    if(nb == 0) {
+      defScanEnd();
+      break;
+    }
+    defScanChunk(defScan.raw.data(), nb);
+  }
+  size_t nb = min(len, defScan.out.size() - defScan.out_pos);
+  memcpy(buf, defScan.out.data() + defScan.out_pos, nb);
+  defScan.out_pos += nb;
+  return nb;
+}
+
+// Feeds ReadDefNets the recorded header, the NETS statement and END DESIGN
+static thread_local struct {
+  long long ranges[2][2];
+  int range;
+  long long left; /* bytes left in ranges[range] */
+  bool tail_done;
+} defNets;
+
+static size_t defNetsRead(FILE* file, char* buf, size_t len) {
+  static const char tail[] = "END DESIGN\n";
+  size_t nb = 0;
+  while(nb < len) {
+    if(defNets.range < 2) {
+      if(defNets.left == 0) {
+        if(++defNets.range < 2) {
+          gzseek((gzFile)file, defNets.ranges[defNets.range][0], SEEK_SET);
+          defNets.left = defNets.ranges[defNets.range][1] -
+                         defNets.ranges[defNets.range][0];
+        }
+        continue;
+      }
+      size_t want = min((long long)(len - nb), defNets.left);
+      int z = gzread((gzFile)file, buf + nb, want);
+      if(z <= 0) {
+        defNets.left = 0;
+        continue;
+      }
+      nb += z;
+      defNets.left -= z;
+    }
+    else {
+      if(!defNets.tail_done && nb + sizeof(tail) - 1 <= len) {
+        memcpy(buf + nb, tail, sizeof(tail) - 1);
+        nb += sizeof(tail) - 1;
+        defNets.tail_done = true;
+      }
+      break;
+    }
+  }
+  return nb;
+}
+
+// A list of byte ranges read in turn; defrRead gets it as its FILE*
+struct defPieces {
+  vector< pair< const char*, size_t > > parts;
+  size_t part;
+  size_t off;
+};
+
+static size_t defPiecesRead(FILE* file, char* buf, size_t len) {
+  defPieces* in = (defPieces*)file;
+  size_t nb = 0;
+  while(nb < len && in->part < in->parts.size()) {
+    const pair< const char*, size_t >& part = in->parts[in->part];
+    size_t n = min(len - nb, part.second - in->off);
+    memcpy(buf + nb, part.first + in->off, n);
+    nb += n;
+    in->off += n;
+    if(in->off == part.second) {
+      in->part++;
+      in->off = 0;
+    }
+  }
+  return nb;
+}
+
+// With num_cpu > 1 the COMPONENTS, PINS and NETS bodies of a mapped DEF
+// are split at record starts and the chunks parsed on worker threads into
+// def_records. The main pass reads the file without those bodies and
+// replays the chunks in file order at each END statement, so ids come out
+// as in a serial read.
+struct defChunk {
+  int section;
+  const char* begin;
+  const char* end;
+  opendp::def_records recs;
+};
+
+static thread_local struct {
+  vector< defChunk > chunks;
+  bool cut[3]; /* body parsed by the workers */
+} defSplit;
+
+static const char* defSplitHeads[3] = {"COMPONENTS 0 ;\n", "PINS 0 ;\n",
+                                       "NETS 0 ;\n"};
+static const char* defSplitTails[3] = {"END COMPONENTS\nEND DESIGN\n",
+                                       "END PINS\nEND DESIGN\n",
+                                       "END NETS\nEND DESIGN\n"};
+
+// a line whose first word is "-"
+static bool defRecordStart(const char* p, const char* end) {
+  while(p < end && (*p == ' ' || *p == '\t')) p++;
+  return p + 1 < end && p[0] == '-' && (p[1] == ' ' || p[1] == '\t');
+}
+
+static const char* defNextLine(const char* p, const char* end) {
+  const char* nl = (const char*)memchr(p, '\n', end - p);
+  return (nl == NULL) ? end : nl + 1;
+}
+
+// splits a section body into chunks of about want bytes; false if
+// anything but blank or comment lines comes before the first record
+static bool defSplitBody(int section, const char* b, const char* e,
+                         size_t want) {
+  const char* p = b;
+  while(p < e && !defRecordStart(p, e)) {
+    const char* q = p;
+    while(q < e && isspace((unsigned char)*q) && *q != '\n') q++;
+    if(q < e && *q != '\n' && *q != '#') return false;
+    p = defNextLine(p, e);
+  }
+  while(p < e) {
+    const char* q = p + want;
+    if(q >= e)
+      q = e;
+    else {
+      q = defNextLine(q, e);
+      while(q < e && !defRecordStart(q, e)) q = defNextLine(q, e);
+    }
+    defSplit.chunks.emplace_back();
+    defChunk& chunk = defSplit.chunks.back();
+    chunk.section = section;
+    chunk.begin = p;
+    chunk.end = q;
+    p = q;
+  }
+  return true;
+}
+
+// parses one chunk behind the header [map, map + prelude), on this
+// thread's own reader state
+static void defParseChunk(defChunk& chunk, const char* fileStr,
+                          const char* map, size_t prelude) {
+  fout = stdout;
+  defrSetLogFunction(myLogFunction);
+  defrInitSession(0);
+  defrSetWarningLogFunction(printWarning);
+  switch(chunk.section) {
+    case 0:
+      defrSetComponentCbk(opendp::CircuitParser::DefComponentRecCbk);
+      break;
+    case 1:
+      defrSetPinCbk((defrPinCbkFnType)opendp::CircuitParser::DefPinRecCbk);
+      break;
+    default:
+      defrSetNetCbk(opendp::CircuitParser::DefNetRecCbk);
+      break;
+  }
+  defrSetAddPathToNet();
+
+  defPieces in;
+  in.parts.push_back(make_pair(map, prelude));
+  in.parts.push_back(make_pair(defSplitHeads[chunk.section],
+                               strlen(defSplitHeads[chunk.section])));
+  in.parts.push_back(make_pair(chunk.begin, (size_t)(chunk.end - chunk.begin)));
+  in.parts.push_back(make_pair(defSplitTails[chunk.section],
+                               strlen(defSplitTails[chunk.section])));
+  in.part = in.off = 0;
+  defrSetReadFunction(defPiecesRead);
+  int res = defrRead((FILE*)&in, fileStr, &chunk.recs, 1);
+  if( res ) {
+    cout << "Reader returns bad status: " << fileStr << " "
+      << defBodyWords[chunk.section] << " at byte "
+      << chunk.begin - map << endl;
+    exit(1);
+  }
+  defrUnsetReadFunction();
+  defrClear();
+}
+
+// splits and parses what it can; returns the pieces left for the main pass
+static bool defSplitRead(circuit* ckt, const char* fileStr, defPieces& rest) {
+  defSplit.chunks.clear();
+  if(ckt->num_cpu < 2 || defScan.prelude_end < 0) return false;
+  size_t want = max((long long)1 << 18,
+                    defScan.map_len / ((long long)ckt->num_cpu * 4));
+  int order[3] = {0, 1, 2};
+  for(int s = 0; s < 3; s++) {
+    long long b = defScan.body[s][0], e = defScan.body[s][1];
+    defSplit.cut[s] = b >= defScan.prelude_end && e >= b &&
+                      defSplitBody(s, defScan.map + b, defScan.map + e, want);
+    if(!defSplit.cut[s]) {
+      while(!defSplit.chunks.empty() && defSplit.chunks.back().section == s)
+        defSplit.chunks.pop_back();
+    }
+  }
+  if(defSplit.chunks.empty()) return false;
+
+  int num = defSplit.chunks.size();
+  vector< defChunk >& chunks = defSplit.chunks;
+  const char* map = defScan.map;
+  size_t prelude = defScan.prelude_end;
+#pragma omp parallel for schedule(dynamic) num_threads(ckt->num_cpu)
+  for(int i = 0; i < num; i++) {
+    defParseChunk(chunks[i], fileStr, map, prelude);
+  }
+
+  // the main pass sees the file minus the parsed bodies
+  sort(order, order + 3, [](int a, int b) {
+    return defScan.body[a][0] < defScan.body[b][0];
+  });
+  long long pos = 0;
+  rest.parts.clear();
+  for(int s : order) {
+    if(!defSplit.cut[s]) continue;
+    rest.parts.push_back(
+        make_pair(defScan.map + pos, (size_t)(defScan.body[s][0] - pos)));
+    pos = defScan.body[s][1];
+  }
+  rest.parts.push_back(
+      make_pair(defScan.map + pos, (size_t)(defScan.map_len - pos)));
+  rest.part = rest.off = 0;
+  return true;
+}
+
+// END COMPONENTS / PINS / NETS of the main pass
+static int defSplitEndCbk(defrCallbackType_e c, void*, defiUserData ud) {
+  int section = (c == defrComponentEndCbkType) ? 0
+                : (c == defrPinEndCbkType)     ? 1
+                                               : 2;
+  for(defChunk& chunk : defSplit.chunks) {
+    if(chunk.section != section) continue;
+    opendp::CircuitParser::ApplyRecords((circuit*)ud, chunk.recs);
+    chunk.recs = opendp::def_records();
+  }
+  return 0;
+}
+
 static char* orientStr(int orient) {
   switch(orient) {
     case 0:
@@ -2708,7 +3125,7 @@ void freeCB(void* name) {
 BEGIN_LEFDEF_PARSER_NAMESPACE
 extern long long nlines;
 END_LEFDEF_PARSER_NAMESPACE
-static int ccr1131444 = 0;
+static thread_local int ccr1131444 = 0;
 
 void lineNumberCB(long long lineNo) {
   // The CCR 1131444 tests ability of the DEF parser to count
@@ -2728,8 +3145,6 @@ int unUsedCB(defrCallbackType_e, void*, defiUserData) {
   return 0;
 }
 
-static void printWarning(const char* str) { fprintf(stderr, "%s\n", str); }
-
 int circuit::ReadDef(const string& defName) {
   FILE* f = NULL;
   //  long start_mem;
@@ -2745,6 +3160,30 @@ int circuit::ReadDef(const string& defName) {
   CircuitParser cp(this);
   userData = cp.Circuit();
 
+  char* fileStr = strdup(defName.c_str());
+  bool gz = is_gz_file(defName);
+  defScan.pos = defScan.line_begin = 0;
+  defScan.head_len = 0;
+  defScan.head_done = defScan.after_nets = false;
+  defScan.after_head = -1;
+  defScan.in_nets = defScan.drop = defScan.eof = false;
+  defScan.record_only = false;
+  defScan.gz = gz;
+  defScan.skip_nets = lazy_nets;
+  for(int s = 0; s < 3; s++) {
+    defScan.body[s][0] = defScan.body[s][1] = -1;
+  }
+  defScan.prelude_end = defScan.nets_begin = defScan.nets_end = -1;
+  defScan.out.clear();
+  defScan.out_pos = 0;
+  defScan.map = NULL;
+  defScan.map_len = 0;
+  // a plain DEF the parser sees whole is mapped and tokenized in place,
+  // or with several threads has its records parsed by sections first
+  bool mapped = !gz && !lazy_nets && defScanMapped(fileStr);
+  defPieces rest;
+  bool split = mapped && defSplitRead(this, fileStr, rest);
+
   defrSetLogFunction(myLogFunction);
 
   defrInitSession(0);
@@ -2778,8 +3217,17 @@ int circuit::ReadDef(const string& defName) {
   // pins
   defrSetPinCbk((defrPinCbkFnType)cp.DefPinCbk);
 
-  // Nets
-  defrSetNetCbk(cp.DefNetCbk);
+  // Nets, unless ReadDefNets parses them later
+  if(!lazy_nets) {
+    defrSetNetCbk(cp.DefNetCbk);
+  }
+
+  // records parsed by defSplitRead go in at the end of their section
+  if(split) {
+    defrSetComponentEndCbk(defSplitEndCbk);
+    defrSetPinEndCbk(defSplitEndCbk);
+    defrSetNetEndCbk(defSplitEndCbk);
+  }
   // SpecialNets
 //  defrSetSNetWireCbk(cp.DefSNetWireCbk);
 //  defrSetSNetWireCbk(snetwire);
@@ -2939,14 +3387,29 @@ int circuit::ReadDef(const string& defName) {
 
 
   ////// File Read 
-  char* fileStr = strdup(defName.c_str());
-  if((f = fopen(fileStr, "r")) == 0) {
+  // .def.gz is inflated on the fly
+  f = gz ? (FILE*)defrGZipOpen(fileStr, "r") : fopen(fileStr, "r");
+  if(f == 0) {
     fprintf(stderr, "**\nERROR: Couldn't open input file '%s'\n",
             fileStr);
     exit(1);
   }     
 
-  int res = defrRead(f, fileStr, userData, 1);
+  int res = 0;
+  if(split) {
+    defrSetReadFunction(defPiecesRead);
+    res = defrRead((FILE*)&rest, fileStr, userData, 1);
+  }
+  else {
+    if(mapped) {
+      defrSetMmapInput();
+    }
+    else {
+      defScan.raw.resize(1 << 16);
+      defrSetReadFunction(defScanRead);
+    }
+    res = defrRead(f, fileStr, userData, 1);
+  }
   if( res ) {
     cout << "Reader returns bad status: " << fileStr << endl;
     exit(1); 
@@ -2955,6 +3418,28 @@ int circuit::ReadDef(const string& defName) {
     cout << "Reading " << fileStr << " is Done" << endl;  
   } 
 
+  defrUnsetReadFunction();
+  defrUnsetMmapInput();
+  if( defScan.body[0][0] >= 0 && defScan.body[0][1] >= 0 ) {
+    def_comps_begin = defScan.body[0][0];
+    def_comps_end = defScan.body[0][1];
+  }
+  nets_deferred = false;
+  if( lazy_nets && defScan.nets_begin >= 0 && defScan.nets_end >= 0 ) {
+    def_prelude_end =
+        (defScan.prelude_end < 0) ? defScan.nets_begin : defScan.prelude_end;
+    def_nets_begin = defScan.nets_begin;
+    def_nets_end = defScan.nets_end;
+    nets_deferred = true;
+  }
+  defScan.raw = vector< char >();
+  defScan.out = string();
+#ifndef WIN32
+  if(defScan.map != NULL) munmap((void*)defScan.map, defScan.map_len);
+#endif
+  defScan.map = NULL;
+  defSplit.chunks = vector< defChunk >();
+
 
   //// defrUnset all Cbk functions
   (void)defrPrintUnusedCallbacks(fout);
@@ -2975,6 +3460,9 @@ int circuit::ReadDef(const string& defName) {
 
   defrUnsetComponentCbk();
   defrUnsetNetCbk();
+  defrUnsetComponentEndCbk();
+  defrUnsetPinEndCbk();
+  defrUnsetNetEndCbk();
   defrUnsetRegionCbk();
   defrUnsetGroupCbk();
   
@@ -3088,7 +3576,10 @@ int circuit::ReadDef(const string& defName) {
 //  defrUnsetViaEndCbk();
 
 
-  fclose(f);
+  if(gz)
+    defrGZipClose(f);
+  else
+    fclose(f);
 
   // Release allocated singleton data.
   defrClear();
@@ -3096,59 +3587,54 @@ int circuit::ReadDef(const string& defName) {
   return res;
 }
 
-
-// takes inputDef, and writeOut in ckt->fileOut pointer
-void circuit::WriteDefComponents(const string& defName) {
-  FILE* f = NULL;
-  //  long start_mem;
-  int line_num_print_interval = 10000;
-
-  //  start_mem = (long)sbrk(0);
+//
+// Parses the NETS statement ReadDef skipped under lazy_nets. The parser
+// only sees the header ( DIVIDERCHAR, BUSBITCHARS, ... ) and NETS.
+//
+int circuit::ReadDefNets() {
   fout = stdout;
   CircuitParser cp(this);
   userData = cp.Circuit();
 
-//  defrSetLogFunction(myLogFunction);
-
+  defrSetLogFunction(myLogFunction);
   defrInitSession(0);
+  defrSetWarningLogFunction(myWarningLogFunction);
   defrSetUserData(userData);
-  (void)defrSetOpenLogFileAppend();
- 
-  // 
-  // CircuitCallBack 
-  //
-  defrSetComponentCbk(cp.DefComponentWriteCbk);
-  
 
-  ////// File Read 
-  char* fileStr = strdup(defName.c_str());
-  if((f = fopen(fileStr, "r")) == 0) {
-    fprintf(stderr, "**\nERROR: Couldn't open output file '%s'\n",
-            fileStr);
-    exit(1);
-  }     
+  defrSetNetStartCbk(cp.DefStartCbk);
+  defrSetNetCbk(cp.DefNetCbk);
 
-  int res = defrRead(f, fileStr, userData, 1);
+  // gzopen reads plain files as they are
+  gzFile in = gzopen(in_def_name.c_str(), "rb");
+  if(in == NULL) {
+    fprintf(stderr, "**\nERROR: Couldn't open input file '%s'\n",
+            in_def_name.c_str());
+    exit(1);
+  }
+  gzbuffer(in, 1 << 18);
+
+  defNets.ranges[0][0] = 0;
+  defNets.ranges[0][1] = def_prelude_end;
+  defNets.ranges[1][0] = def_nets_begin;
+  defNets.ranges[1][1] = def_nets_end;
+  defNets.range = 0;
+  defNets.left = def_prelude_end;
+  defNets.tail_done = false;
+  defrSetReadFunction(defNetsRead);
+
+  int res = defrRead((FILE*)in, in_def_name.c_str(), userData, 1);
   if( res ) {
-    cout << "Reader returns bad status: " << fileStr << endl;
-    exit(1); 
+    cout << "Reader returns bad status: " << in_def_name << endl;
+    exit(1);
   }
-  else {
-    cout << "Reading " << fileStr << " is Done" << endl;  
-  } 
+  cout << "Reading NETS of " << in_def_name << " is Done" << endl;
 
-
-  //// defrUnset all Cbk functions
-//  (void)defrPrintUnusedCallbacks(fout);
+  defrUnsetReadFunction();
   (void)defrReleaseNResetMemory();
-
   (void)defrUnsetCallbacks();
-  (void)defrSetUnusedCallbacks(unUsedCB);
-
-  defrUnsetComponentCbk();
-
-  fclose(f);
-
-  // Release allocated singleton data.
+  gzclose(in);
   defrClear();
+
+  nets_deferred = false;
+  return res;
 }
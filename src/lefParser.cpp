@@ -6,6 +6,7 @@
 #include "lefiDebug.hpp"
 #include "lefiEncryptInt.hpp"
 #include "lefiUtil.hpp"
+#include "lefzlib.hpp"
 
 using opendp::circuit;
 
@@ -22,9 +23,9 @@ using std::make_pair;
 using std::to_string;
 using std::string;
 
-static FILE* fout;
-static int parse65nm = 0;
-static int parseLef58Type = 0;
+static thread_local FILE* fout;
+static thread_local int parse65nm = 0;
+static thread_local int parseLef58Type = 0;
 
 // TX_DIR:TRANSLATION ON
 
@@ -2189,6 +2190,14 @@ circuit::ReadLef(const vector<string>& lefStor) {
 
   // start_mem = (long)sbrk(0);
 
+  // a library parsed before is loaded from lef_cache_dir instead
+  string cacheFile;
+  if( !lef_cache_dir.empty() ) {
+    cacheFile = lef_cache_file(lefStor);
+    if( !cacheFile.empty() && load_lef_cache(cacheFile) ) {
+      return 0;
+    }
+  }
 
   fout = stdout;
   CircuitParser cp(this);
@@ -2334,11 +2343,17 @@ circuit::ReadLef(const vector<string>& lefStor) {
 //  (void) lefrSetShiftCase();  // will shift name to uppercase if caseinsensitive
   // is set to off or not set
   lefrSetOpenLogFileAppend();
+  // plain LEFs are mapped and tokenized in place
+  lefrSetMmapInput();
 
   for(auto curLefLoc : lefStor) {
     lefrReset();
 
-    if ((f = fopen(curLefLoc.c_str(),"r")) == 0) {
+    // .lef.gz : lefGZipOpen installs the inflating read function
+    bool gz = is_gz_file(curLefLoc);
+    f = gz ? (FILE*)lefGZipOpen(curLefLoc.c_str(), "r")
+           : fopen(curLefLoc.c_str(), "r");
+    if (f == 0) {
       cout << "Couldn't open input file " << curLefLoc << endl;
       return(2);
     }
@@ -2363,6 +2378,10 @@ circuit::ReadLef(const vector<string>& lefStor) {
 //    (void)lefrPrintUnusedCallbacks(fout);
     (void)lefrReleaseNResetMemory();
 
+    if (gz)
+      lefGZipClose(f);
+    else
+      fclose(f);
   }
   (void)lefrUnsetCallbacks();
   void lefrUnsetMacroBeginCbk();
@@ -2426,10 +2445,11 @@ circuit::ReadLef(const vector<string>& lefStor) {
   void lefrUnsetViaRuleCbk();
   */
 
-  fclose(f);
-
   // Release allocated singleton data.
   lefrClear();    
 
+  if( !cacheFile.empty() ) {
+    save_lef_cache(cacheFile);
+  }
   return 0;
 }
@@ -4,7 +4,7 @@ using std::cout;
 using std::endl;
 
 opendp_external::opendp_external() 
-: def_file(""), constraint_file(""), is_evaluated(false) {};
+: def_file(""), constraint_file("") {};
 
 opendp_external::~opendp_external() {};
 
@@ -28,6 +28,48 @@ void opendp_external::export_def(const char* def) {
   ckt.write_def(def);
 }
 
+bool opendp_external::save_snapshot(const char* file) {
+  return ckt.save_snapshot(file);
+}
+
+// replaces import_lef / import_def / init_opendp
+bool opendp_external::load_snapshot(const char* file) {
+  if( !ckt.load_snapshot(file) ) {
+    return false;
+  }
+  def_file = ckt.in_def_name;
+  return true;
+}
+
+void opendp_external::set_thread_count(int count) {
+  ckt.num_cpu = (count < 1) ? 1 : count;
+}
+
+void opendp_external::set_strip_placement(bool enable) {
+  ckt.strip_placement = enable;
+}
+
+void opendp_external::set_lazy_nets(bool enable) {
+  ckt.lazy_nets = enable;
+}
+
+void opendp_external::set_lef_cache(const char* dir) {
+  ckt.lef_cache_dir = dir;
+}
+
+bool opendp_external::set_legalize_engine(const char* engine) {
+  if(strcmp(engine, "pixel") == 0)
+    ckt.cluster_engine = false;
+  else if(strcmp(engine, "cluster") == 0)
+    ckt.cluster_engine = true;
+  else {
+    cout << "ERROR: unknown legalize engine '" << engine
+         << "' ( pixel / cluster )" << endl;
+    return false;
+  }
+  return true;
+}
+
 bool opendp_external::init_opendp() {
   if( ckt.ReadLef(lef_stor)) {
     return false;
@@ -46,8 +88,12 @@ bool opendp_external::init_opendp() {
 }
 
 bool opendp_external::legalize_place() {
-  ckt.simple_placement(nullptr);
+  if(ckt.cluster_engine)
+    ckt.cluster_placement(nullptr);
+  else
+    ckt.simple_placement(nullptr);
   ckt.calc_density_factor(4);
+  return true;
 }
 
 bool opendp_external::check_legality() {
@@ -59,33 +105,21 @@ double opendp_external::get_utilization() {
 }
 
 double opendp_external::get_sum_displacement() {
-  if( !is_evaluated ) {
-    ckt.evaluation();
-    is_evaluated = true;
-  }
-  return ckt.sum_displacement;
+  return ckt.current_sum_disp();
 }
 
 double opendp_external::get_average_displacement() {
-  if( !is_evaluated ) {
-    ckt.evaluation();
-    is_evaluated = true;
-  }
-  return ckt.avg_displacement;
+  return ckt.current_sum_disp() / ckt.cells.size();
 }
 
 double opendp_external::get_max_displacement() {
-  if( !is_evaluated ) {
-    ckt.evaluation();
-    is_evaluated = true;
-  }
-  return ckt.max_displacement;
+  return ckt.current_max_disp();
 }
 
 double opendp_external::get_original_hpwl() {
-  return ckt.HPWL("INIT");
+  return ckt.initial_hpwl();
 }
 
 double opendp_external::get_legalized_hpwl() {
-  return ckt.HPWL("");
+  return ckt.current_hpwl();
 }
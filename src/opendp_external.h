@@ -16,6 +16,14 @@ public:
   void import_def(const char* def);
   void import_constraint(const char* constraint);
   void export_def(const char* def);
+  bool save_snapshot(const char* file);
+  bool load_snapshot(const char* file);
+
+  void set_thread_count(int count);
+  void set_strip_placement(bool enable);
+  void set_lazy_nets(bool enable);
+  void set_lef_cache(const char* dir);
+  bool set_legalize_engine(const char* engine);
 
   bool init_opendp();
   bool legalize_place();
@@ -33,7 +41,6 @@ private:
   std::vector<std::string> lef_stor;
   std::string def_file;
   std::string constraint_file;
-  bool is_evaluated;
 }; 
 
 #endif
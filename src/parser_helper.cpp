@@ -43,6 +43,9 @@ using opendp::row;
 using opendp::pixel;
 using opendp::rect;
 using opendp::pin;
+using opendp::macro_pin;
+using opendp::name_ref;
+using opendp::name_key;
 using opendp::macro;
 using opendp::net;
 using opendp::site;
@@ -67,12 +70,11 @@ using std::string;
 using std::fixed;
 using std::numeric_limits;
 
-// requires full name, e.g., cell_instance/pin
+// PI/PO pins, by the name in DEF PINS
 pin *circuit::locateOrCreatePin(const string &pinName) {
   OPENDP_HASH_MAP< string, unsigned >::iterator it = pin2id.find(pinName);
   if(it == pin2id.end()) {
     pin thePin;
-    thePin.name = pinName;
     thePin.id = pins.size();
     pin2id.insert(make_pair(pinName, thePin.id));
     pins.push_back(thePin);
@@ -82,25 +84,118 @@ pin *circuit::locateOrCreatePin(const string &pinName) {
     return &pins[it->second];
 }
 
-cell *circuit::locateOrCreateCell(const string &cellName) {
-  OPENDP_HASH_MAP< string, unsigned >::iterator it = cell2id.find(cellName);
+// sizes the ( cell, macro pin ) slots once the cells are known; pins
+// created before ( e.g. by a snapshot ) are entered again
+void circuit::init_cell_pins() {
+  cell_pin_start.assign(cells.size() + 1, 0);
+  for(int i = 0; i < cells.size(); i++) {
+    cell_pin_start[i + 1] =
+        cell_pin_start[i] + macros[cells[i].type].pins.size();
+  }
+  cell_pin.assign(cell_pin_start[cells.size()], UINT_MAX);
+  for(int i = 0; i < pins.size(); i++) {
+    pin *thePin = &pins[i];
+    if(thePin->owner == UINT_MAX || thePin->mpin == UINT_MAX) continue;
+    cell_pin[cell_pin_start[thePin->owner] + thePin->mpin] = i;
+  }
+}
+
+// pin macroPin of cells[cellId], offset from the first port's center
+pin *circuit::locateOrCreateCellPin(unsigned cellId, unsigned macroPin) {
+  if(cell_pin_start.size() != cells.size() + 1) init_cell_pins();
+  unsigned &slot = cell_pin[cell_pin_start[cellId] + macroPin];
+  if(slot != UINT_MAX) return &pins[slot];
+
+  macro_pin *myMacroPin = &macros[cells[cellId].type].pins[macroPin];
+  pin thePin;
+  thePin.id = slot = pins.size();
+  thePin.owner = cellId;
+  thePin.mpin = macroPin;
+  thePin.type = NONPIO_PIN;
+  if(!myMacroPin->port.empty()) {
+    thePin.x_offset =
+        myMacroPin->port[0].xLL / 2 + myMacroPin->port[0].xUR / 2;
+    thePin.y_offset =
+        myMacroPin->port[0].yLL / 2 + myMacroPin->port[0].yUR / 2;
+  }
+  pins.push_back(thePin);
+  return &pins[pins.size() - 1];
+}
+
+// instance name of theCell; dummy_cell, which blocks non-row sites, has none
+name_ref circuit::cell_name(const cell *theCell) const {
+  if(theCell->id >= cell_infos.size()) return name_key("FIXED_DUMMY");
+  return cell_infos[theCell->id].name;
+}
+
+// "instance:pin" for pins of cells, the DEF PINS name for PI/POs
+string circuit::pin_name(unsigned pinId) {
+  pin *thePin = &pins[pinId];
+  if(thePin->owner != UINT_MAX && thePin->mpin != UINT_MAX) {
+    cell *theCell = &cells[thePin->owner];
+    return cell_infos[thePin->owner].name.str() + ":" +
+           macros[theCell->type].pins[thePin->mpin].name;
+  }
+  for(OPENDP_HASH_MAP< string, unsigned >::iterator it = pin2id.begin();
+      it != pin2id.end(); ++it) {
+    if(it->second == pinId) return it->first;
+  }
+  return "";
+}
+
+name_ref opendp::name_pool::intern(const char *s, size_t len) {
+  if(cap - used < len + 1) {
+    size_t size = std::max((size_t)NAME_POOL_CHUNK, len + 1);
+    chunks.push_back(std::unique_ptr< char[] >(new char[size]));
+    used = 0;
+    cap = size;
+  }
+  char *dst = chunks.back().get() + used;
+  memcpy(dst, s, len);
+  dst[len] = '\0';
+  used += len + 1;
+  return name_ref(dst, len);
+}
+
+int macro::find_pin(const char *pinName) const {
+  for(int i = 0; i < pins.size(); i++) {
+    if(pins[i].name == pinName) return i;
+  }
+  return -1;
+}
+
+macro_pin *macro::locateOrCreatePin(const string &pinName) {
+  int i = find_pin(pinName.c_str());
+  if(i < 0) {
+    macro_pin thePin;
+    thePin.name = pinName;
+    pins.push_back(thePin);
+    return &pins[pins.size() - 1];
+  }
+  return &pins[i];
+}
+
+cell *circuit::locateOrCreateCell(name_ref cellName) {
+  OPENDP_HASH_MAP< name_ref, unsigned, name_hash >::iterator it = cell2id.find(cellName);
   if(it == cell2id.end()) {
     cell theCell;
-    theCell.name = cellName;
+    cell_info theInfo;
+    theInfo.name = names.intern(cellName.c_str(), cellName.size());
     theCell.id = cells.size();
-    cell2id.insert(make_pair(theCell.name, cells.size()));
+    cell2id.insert(make_pair(theInfo.name, cells.size()));
     cells.push_back(theCell);
+    cell_infos.push_back(theInfo);
     return &cells[cells.size() - 1];
   }
   else
     return &cells[it->second];
 }
 
-macro *circuit::locateOrCreateMacro(const string &macroName) {
-  OPENDP_HASH_MAP< string, unsigned >::iterator it = macro2id.find(macroName);
+macro *circuit::locateOrCreateMacro(name_ref macroName) {
+  OPENDP_HASH_MAP< name_ref, unsigned, name_hash >::iterator it = macro2id.find(macroName);
   if(it == macro2id.end()) {
     macro theMacro;
-    theMacro.name = macroName;
+    theMacro.name = names.intern(macroName.c_str(), macroName.size());
     macro2id.insert(make_pair(theMacro.name, macros.size()));
     macros.push_back(theMacro);
     return &macros[macros.size() - 1];
@@ -109,11 +204,11 @@ macro *circuit::locateOrCreateMacro(const string &macroName) {
     return &macros[it->second];
 }
 
-net *circuit::locateOrCreateNet(const string &netName) {
-  OPENDP_HASH_MAP< string, unsigned >::iterator it = net2id.find(netName);
+net *circuit::locateOrCreateNet(name_ref netName) {
+  OPENDP_HASH_MAP< name_ref, unsigned, name_hash >::iterator it = net2id.find(netName);
   if(it == net2id.end()) {
     net theNet;
-    theNet.name = netName;
+    theNet.name = names.intern(netName.c_str(), netName.size());
     net2id.insert(make_pair(theNet.name, nets.size()));
     nets.push_back(theNet);
     return &nets[nets.size() - 1];
@@ -189,6 +284,78 @@ group *circuit::locateOrCreateGroup(const string &groupName) {
     return &groups[it->second];
 }
 
+// glob match, '*' any run and '?' any one character
+static bool wildcard_match(const char *pattern, const char *name) {
+  const char *star = NULL;
+  const char *retry = NULL;
+  while(*name) {
+    if(*pattern == '*') {
+      star = pattern++;
+      retry = name;
+    }
+    else if(*pattern == '?' || *pattern == *name) {
+      pattern++;
+      name++;
+    }
+    else if(star) {
+      pattern = star + 1;
+      name = ++retry;
+    }
+    else
+      return false;
+  }
+  while(*pattern == '*') pattern++;
+  return *pattern == '\0';
+}
+
+// GROUPS member pattern : the literal prefix before the first wildcard is
+// found by binary search over cell_name_order, then only that range is
+// matched
+void circuit::add_group_members(group *theGroup, const string &pattern) {
+  if(cell_name_order.size() != cells.size()) {
+    cell_name_order.resize(cells.size());
+    for(unsigned i = 0; i < cells.size(); i++) cell_name_order[i] = i;
+    sort(cell_name_order.begin(), cell_name_order.end(),
+         [&](unsigned lhs, unsigned rhs) {
+           return cell_infos[lhs].name < cell_infos[rhs].name;
+         });
+  }
+
+  size_t wild = pattern.find_first_of("*?");
+  string prefix = pattern.substr(0, wild);
+  bool prefix_only = (wild != string::npos && wild + 1 == pattern.size() &&
+                      pattern[wild] == '*');
+  unsigned groupId = group2id[theGroup->name];
+  size_t first = theGroup->siblings.size();
+
+  vector< unsigned >::iterator it = lower_bound(
+      cell_name_order.begin(), cell_name_order.end(), name_key(prefix),
+      [&](unsigned id, const name_ref &key) {
+        return cell_infos[id].name < key;
+      });
+  for(; it != cell_name_order.end(); ++it) {
+    cell *theCell = &cells[*it];
+    name_ref cellName = cell_infos[*it].name;
+    if(cellName.size() < prefix.size() ||
+       memcmp(cellName.c_str(), prefix.data(), prefix.size()) != 0)
+      break;
+    if(wild == string::npos) {
+      if(cellName.size() != prefix.size()) break;
+    }
+    else if(!prefix_only &&
+            !wildcard_match(pattern.c_str() + wild,
+                            cellName.c_str() + prefix.size()))
+      continue;
+    if(theCell->inGroup && theCell->group == groupId) continue;
+    theGroup->siblings.push_back(theCell);
+    theCell->group = groupId;
+    theCell->inGroup = true;
+  }
+  // members in cell order, as the linear scan added them
+  sort(theGroup->siblings.begin() + first, theGroup->siblings.end(),
+       [](cell *lhs, cell *rhs) { return lhs->id < rhs->id; });
+}
+
 /* generic helper functions */
 bool opendp::is_special_char(char c) {
   static const char specialChars[] = {'(', ')', ',', ':', ';', '/',  '#',
@@ -264,15 +431,28 @@ void opendp::get_next_n_tokens(ifstream &is, vector< string > &tokens,
   } while(!is.eof() && count < numTokens);
 }
 
+static const char *orientNames[] = {"N", "W", "S", "E", "FN", "FW", "FS", "FE"};
+
+opendp::orient opendp::orient_of(const string &name) {
+  for(int i = 0; i < 8; i++) {
+    if(name == orientNames[i]) return static_cast< orient >(i);
+  }
+  cerr << "opendp::orient_of == invalid orient " << name << endl;
+  exit(2);
+}
+
+const char *opendp::orient_name(orient o) { return orientNames[o]; }
+
+bool opendp::is_gz_file(const string &name) {
+  return name.size() > 3 && name.compare(name.size() - 3, 3, ".gz") == 0;
+}
+
 void cell::print() {
   cout << "|=== BEGIN CELL ===|" << endl;
-  cout << "name:               " << name << endl;
+  cout << "id:                 " << id << endl;
   cout << "type:               " << type << endl;
-  cout << "orient:             " << cellorient << endl;
+  cout << "orient:             " << orient_name(cellorient) << endl;
   cout << "isFixed?            " << (isFixed ? "true" : "false") << endl;
-  for(OPENDP_HASH_MAP< string, unsigned >::iterator it = ports.begin();
-      it != ports.end(); it++)
-    cout << "port: " << (*it).first << " - " << (*it).second << endl;
   cout << "(init_x,  init_y):  " << init_x_coord << ", " << init_y_coord
        << endl;
   cout << "(x_coord,y_coord):  " << x_coord << ", " << y_coord << endl;
@@ -296,7 +476,7 @@ void row::print() {
   cout << "(origX,origY):     " << origX << ", " << origY << endl;
   cout << "(stepX,stepY):     " << stepX << ", " << stepY << endl;
   cout << "numSites:          " << numSites << endl;
-  cout << "orientation:       " << siteorient << endl;
+  cout << "orientation:       " << orient_name(siteorient) << endl;
   cout << "|===  END  ROW ===|" << endl;
 }
 
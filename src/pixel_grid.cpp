@@ -0,0 +1,461 @@
+/////////////////////////////////////////////////////////////////////////////
+// Authors: SangGi Do(sanggido@unist.ac.kr), Mingyu Woo(mwoo@eng.ucsd.edu)
+//          (respective Ph.D. advisors: Seokhyeong Kang, Andrew B. Kahng)
+//
+//          Original parsing structure was made by Myung-Chul Kim (IBM).
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, SangGi Do and Mingyu Woo
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "circuit.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using opendp::free_gap;
+using opendp::pixel_grid;
+
+using std::vector;
+
+// set bits [from, to) of one bitmap row
+static void set_bits(vector< uint64_t >& bits, size_t offset, int from, int to,
+                     bool value) {
+  for(int w = from >> 6; w <= (to - 1) >> 6; w++) {
+    uint64_t mask = ~0ULL;
+    if(w == from >> 6) mask &= ~0ULL << (from & 63);
+    if(w == (to - 1) >> 6 && (to & 63) != 0) mask &= ~0ULL >> (64 - (to & 63));
+    // atomic : concurrent tasks may paint other bits of the same word
+    if(value)
+      __atomic_fetch_or(&bits[offset + w], mask, __ATOMIC_RELAXED);
+    else
+      __atomic_fetch_and(&bits[offset + w], ~mask, __ATOMIC_RELAXED);
+  }
+}
+
+// blocked sites of word w over rows [y, y + y_step)
+static inline uint64_t blocked_word(const vector< uint64_t >& occupied,
+                                    const vector< uint64_t >& legal,
+                                    int words_per_row, int y, int y_step,
+                                    int w) {
+  uint64_t blocked = 0;
+  for(int k = y; k < y + y_step; k++) {
+    size_t idx = static_cast< size_t >(k) * words_per_row + w;
+    blocked |= ~legal[idx] | occupied[idx];
+  }
+  return blocked;
+}
+
+// 64 sites of one bitmap row starting at site x ( zero past the row end )
+static inline uint64_t window_word(const vector< uint64_t >& bits,
+                                   size_t offset, int words_per_row, int x) {
+  int w = x >> 6;
+  int shift = x & 63;
+  uint64_t lo = (w < words_per_row) ? bits[offset + w] : 0;
+  if(shift == 0) return lo;
+  uint64_t hi = (w + 1 < words_per_row) ? bits[offset + w + 1] : 0;
+  return (lo >> shift) | (hi << (64 - shift));
+}
+
+// first gap of a row ordered after ( group, x )
+template < class Iter >
+static inline Iter gap_after(Iter begin, Iter end, unsigned short group,
+                             int x) {
+  return std::partition_point(begin, end, [group, x](const free_gap& gap) {
+    return gap.group < group || (gap.group == group && gap.start <= x);
+  });
+}
+
+// smallest x' in [x, x_max] such that [x', x' + run) lies in one gap
+static int row_fit_right(const vector< free_gap >& row, unsigned short group,
+                         int x, int run, int x_max) {
+  vector< free_gap >::const_iterator it =
+      gap_after(row.begin(), row.end(), group, x);
+  if(it != row.begin()) {
+    vector< free_gap >::const_iterator prev = it - 1;
+    if(prev->group == group && prev->end - x >= run) return x;
+  }
+  for(; it != row.end() && it->group == group && it->start <= x_max; ++it) {
+    if(it->end - it->start >= run) return it->start;
+  }
+  return -1;
+}
+
+// largest x' in [x_min, x] such that [x', x' + run) lies in one gap
+static int row_fit_left(const vector< free_gap >& row, unsigned short group,
+                        int x, int run, int x_min) {
+  vector< free_gap >::const_iterator it =
+      gap_after(row.begin(), row.end(), group, x);
+  while(it != row.begin()) {
+    --it;
+    if(it->group != group || it->end - run < x_min) break;
+    int fit = std::min(x, it->end - run);
+    if(fit >= it->start) return fit;
+  }
+  return -1;
+}
+
+#ifdef __AVX2__
+// true if any site of words [w, w + 4) is blocked
+static inline bool blocked_quad(const vector< uint64_t >& occupied,
+                                const vector< uint64_t >& legal,
+                                int words_per_row, int y, int y_step, int w) {
+  __m256i blocked = _mm256_setzero_si256();
+  for(int k = y; k < y + y_step; k++) {
+    size_t idx = static_cast< size_t >(k) * words_per_row + w;
+    __m256i occ = _mm256_loadu_si256((const __m256i*)&occupied[idx]);
+    __m256i leg = _mm256_loadu_si256((const __m256i*)&legal[idx]);
+    // ~leg | occ
+    blocked = _mm256_or_si256(blocked, _mm256_andnot_si256(
+                  _mm256_andnot_si256(occ, leg), _mm256_set1_epi64x(-1)));
+  }
+  return !_mm256_testz_si256(blocked, blocked);
+}
+#endif
+
+// rebuild bitmaps and free gaps from linked_cell / group / isValid
+// ( call once the grid is fully initialized )
+void pixel_grid::build_bitmaps() {
+  std::fill(occupied.begin(), occupied.end(), 0);
+  std::fill(legal[0].begin(), legal[0].end(), 0);
+  std::fill(legal[1].begin(), legal[1].end(), 0);
+
+  for(int i = 0; i < row_num; i++) {
+    size_t offset = static_cast< size_t >(i) * words_per_row;
+    for(int j = 0; j < col_num; j++) {
+      size_t idx = index(i, j);
+      uint64_t bit = 1ULL << (j & 63);
+      if(linked_cell[idx] != PIXEL_EMPTY) occupied[offset + (j >> 6)] |= bit;
+      if(isValid[idx] == false) continue;
+      if(group[idx] == PIXEL_NO_GROUP)
+        legal[0][offset + (j >> 6)] |= bit;
+      else
+        legal[1][offset + (j >> 6)] |= bit;
+    }
+  }
+
+  build_gaps();
+  return;
+}
+
+// rebuild free gaps, split at segment boundaries
+void pixel_grid::build_gaps() {
+  group_num = 0;
+  for(size_t i = 0; i < group.size(); i++) {
+    if(group[i] != PIXEL_NO_GROUP)
+      group_num = std::max(group_num, group[i] + 1);
+  }
+
+  size_t bucket_num = group_num + seg_begin.size();
+  gaps.assign(row_num * bucket_num, vector< free_gap >());
+  for(int i = 0; i < row_num; i++) {
+    for(int j = 0; j < col_num;) {
+      size_t idx = index(i, j);
+      if(isValid[idx] == false || linked_cell[idx] != PIXEL_EMPTY) {
+        j++;
+        continue;
+      }
+      free_gap gap;
+      gap.start = j;
+      gap.group = group[idx];
+      unsigned short seg = col_seg[j];
+      while(j < col_num && isValid[index(i, j)] == true &&
+            linked_cell[index(i, j)] == PIXEL_EMPTY &&
+            group[index(i, j)] == gap.group && col_seg[j] == seg)
+        j++;
+      gap.end = j;
+      row_gaps(i, gap.start, gap.group).push_back(gap);
+    }
+  }
+  for(size_t i = 0; i < gaps.size(); i++) {
+    std::sort(gaps[i].begin(), gaps[i].end(),
+              [](const free_gap& a, const free_gap& b) {
+                return a.start < b.start;
+              });
+  }
+  return;
+}
+
+// columns [begins[k], begins[k + 1]) form segment k ( begins[0] == 0 )
+void pixel_grid::set_segments(const vector< int >& begins) {
+  seg_begin = begins;
+  col_seg.assign(col_num, 0);
+  for(int k = 1; k < seg_begin.size(); k++) {
+    for(int j = seg_begin[k]; j < col_num; j++) col_seg[j] = k;
+  }
+  build_gaps();
+  return;
+}
+
+// split the gaps covering sites [x_begin, x_end) of row y
+void pixel_grid::take_gap(int y, int x_begin, int x_end) {
+  for(int j = x_begin; j < x_end;) {
+    unsigned short g = group[index(y, j)];
+    vector< free_gap >& row = row_gaps(y, j, g);
+    vector< free_gap >::iterator it =
+        gap_after(row.begin(), row.end(), g, j);
+    if(it == row.begin() || (it - 1)->group != g || (it - 1)->end <= j) {
+      j++;
+      continue;
+    }
+    --it;
+    free_gap left = *it;
+    free_gap right = *it;
+    left.end = j;
+    right.start = std::min(x_end, it->end);
+    j = right.start;
+
+    if(left.start < left.end && right.start < right.end) {
+      *it = left;
+      row.insert(it + 1, right);
+    }
+    else if(left.start < left.end)
+      *it = left;
+    else if(right.start < right.end)
+      *it = right;
+    else
+      row.erase(it);
+  }
+  return;
+}
+
+// merge the free sites of [x_begin, x_end) of row y into its gaps
+void pixel_grid::give_gap(int y, int x_begin, int x_end) {
+  for(int j = x_begin; j < x_end;) {
+    size_t idx = index(y, j);
+    if(isValid[idx] == false || linked_cell[idx] != PIXEL_EMPTY) {
+      j++;
+      continue;
+    }
+    unsigned short g = group[idx];
+    unsigned short seg = col_seg[j];
+    vector< free_gap >& row = row_gaps(y, j, g);
+    int start = j;
+    while(j < x_end && isValid[index(y, j)] == true &&
+          linked_cell[index(y, j)] == PIXEL_EMPTY &&
+          group[index(y, j)] == g && col_seg[j] == seg)
+      j++;
+
+    vector< free_gap >::iterator it =
+        gap_after(row.begin(), row.end(), g, start);
+    bool merge_left =
+        it != row.begin() && (it - 1)->group == g && (it - 1)->end == start;
+    bool merge_right = it != row.end() && it->group == g && it->start == j;
+    if(merge_left && merge_right) {
+      (it - 1)->end = it->end;
+      row.erase(it);
+    }
+    else if(merge_left)
+      (it - 1)->end = j;
+    else if(merge_right)
+      it->start = start;
+    else {
+      free_gap gap;
+      gap.start = start;
+      gap.end = j;
+      gap.group = g;
+      row.insert(it, gap);
+    }
+  }
+  return;
+}
+
+void pixel_grid::paint(int y, int x, int x_step, int y_step,
+                       unsigned cellId) {
+  for(int i = y; i < y + y_step; i++) {
+    for(int j = x; j < x + x_step; j++) {
+      linked_cell[index(i, j)] = cellId;
+    }
+    set_bits(occupied, static_cast< size_t >(i) * words_per_row, x,
+             x + x_step, true);
+    take_gap(i, x, x + x_step);
+  }
+  return;
+}
+
+void pixel_grid::erase(int y, int x, int x_step, int y_step) {
+  for(int i = y; i < y + y_step; i++) {
+    for(int j = x; j < x + x_step; j++) {
+      linked_cell[index(i, j)] = PIXEL_EMPTY;
+    }
+    set_bits(occupied, static_cast< size_t >(i) * words_per_row, x,
+             x + x_step, false);
+    give_gap(i, x, x + x_step);
+  }
+  return;
+}
+
+int pixel_grid::next_blocked(int y, int y_step, int x_begin, int x_end,
+                             unsigned groupId) const {
+  const vector< uint64_t >& bits = legal[(groupId == UINT_MAX) ? 0 : 1];
+  int w_begin = x_begin >> 6;
+  int w_end = (x_end - 1) >> 6;
+
+  for(int w = w_begin; w <= w_end; w++) {
+#ifdef __AVX2__
+    // skip four clean inner words at once
+    if(w > w_begin && w + 3 < w_end &&
+       blocked_quad(occupied, bits, words_per_row, y, y_step, w) == false) {
+      w += 3;
+      continue;
+    }
+#endif
+    uint64_t blocked = blocked_word(occupied, bits, words_per_row, y, y_step, w);
+    if(w == w_begin) blocked &= ~0ULL << (x_begin & 63);
+    if(w == w_end && (x_end & 63) != 0) blocked &= ~0ULL >> (64 - (x_end & 63));
+    if(blocked != 0) return (w << 6) + __builtin_ctzll(blocked);
+  }
+
+  // group sites must also belong to the same group
+  if(groupId != UINT_MAX) {
+    for(int j = x_begin; j < x_end; j++)
+      for(int i = y; i < y + y_step; i++)
+        if(group[index(i, j)] != groupId) return j;
+  }
+  return -1;
+}
+
+int pixel_grid::next_occupied(int y, int x_begin, int x_end) const {
+  size_t offset = static_cast< size_t >(y) * words_per_row;
+  int w_end = (x_end - 1) >> 6;
+  for(int w = x_begin >> 6; w <= w_end; w++) {
+    uint64_t bits = occupied[offset + w];
+    if(w == x_begin >> 6) bits &= ~0ULL << (x_begin & 63);
+    if(w == w_end && (x_end & 63) != 0) bits &= ~0ULL >> (64 - (x_end & 63));
+    if(bits != 0) return (w << 6) + __builtin_ctzll(bits);
+  }
+  return -1;
+}
+
+uint64_t pixel_grid::free_run_starts(int y, int y_step, int x, int count,
+                                     int run, unsigned groupId) const {
+  assert(count + run <= 65);
+  const vector< uint64_t >& bits = legal[(groupId == UINT_MAX) ? 0 : 1];
+
+  uint64_t free = ~0ULL;
+  for(int k = y; k < y + y_step; k++) {
+    size_t offset = static_cast< size_t >(k) * words_per_row;
+    free &= window_word(bits, offset, words_per_row, x) &
+            ~window_word(occupied, offset, words_per_row, x);
+  }
+
+  // keep bit i only if bits [i, i + run) are all free
+  for(int len = 1; len < run && free != 0;) {
+    int shift = std::min(len, run - len);
+    free &= free >> shift;
+    len += shift;
+  }
+  if(count < 64) free &= (1ULL << count) - 1;
+
+  // group sites must also belong to the same group
+  if(groupId != UINT_MAX) {
+    uint64_t candidates = free;
+    while(candidates != 0) {
+      int i = __builtin_ctzll(candidates);
+      candidates &= candidates - 1;
+      bool same_group = true;
+      for(int k = y; k < y + y_step && same_group; k++)
+        for(int j = x + i; j < x + i + run; j++)
+          if(group[index(k, j)] != groupId) {
+            same_group = false;
+            break;
+          }
+      if(same_group == false) free &= ~(1ULL << i);
+    }
+  }
+  return free;
+}
+
+int pixel_grid::prev_blocked(int y, int y_step, int x_begin, int x_end,
+                             unsigned groupId) const {
+  const vector< uint64_t >& bits = legal[(groupId == UINT_MAX) ? 0 : 1];
+  int w_begin = x_begin >> 6;
+  int w_end = (x_end - 1) >> 6;
+
+  for(int w = w_end; w >= w_begin; w--) {
+#ifdef __AVX2__
+    if(w < w_end && w - 3 > w_begin &&
+       blocked_quad(occupied, bits, words_per_row, y, y_step, w - 3) == false) {
+      w -= 3;
+      continue;
+    }
+#endif
+    uint64_t blocked = blocked_word(occupied, bits, words_per_row, y, y_step, w);
+    if(w == w_begin) blocked &= ~0ULL << (x_begin & 63);
+    if(w == w_end && (x_end & 63) != 0) blocked &= ~0ULL >> (64 - (x_end & 63));
+    if(blocked != 0) return (w << 6) + 63 - __builtin_clzll(blocked);
+  }
+
+  if(groupId != UINT_MAX) {
+    for(int j = x_end - 1; j >= x_begin; j--)
+      for(int i = y; i < y + y_step; i++)
+        if(group[index(i, j)] != groupId) return j;
+  }
+  return -1;
+}
+
+// rows agree on x' once no row pushes it further, staying in the segment
+// of x
+int pixel_grid::fit_right(int y, int y_step, int x, int run, unsigned groupId,
+                          int x_max) const {
+  unsigned short g = (groupId == UINT_MAX) ? PIXEL_NO_GROUP : groupId;
+  bool moved = true;
+  while(moved) {
+    moved = false;
+    for(int k = y; k < y + y_step; k++) {
+      int fit = row_fit_right(row_gaps(k, x, g), g, x, run, x_max);
+      if(fit < 0) return -1;
+      if(fit != x) {
+        x = fit;
+        moved = true;
+      }
+    }
+  }
+  return x;
+}
+
+int pixel_grid::fit_left(int y, int y_step, int x, int run, unsigned groupId,
+                         int x_min) const {
+  unsigned short g = (groupId == UINT_MAX) ? PIXEL_NO_GROUP : groupId;
+  bool moved = true;
+  while(moved) {
+    moved = false;
+    for(int k = y; k < y + y_step; k++) {
+      int fit = row_fit_left(row_gaps(k, x, g), g, x, run, x_min);
+      if(fit < 0) return -1;
+      if(fit != x) {
+        x = fit;
+        moved = true;
+      }
+    }
+  }
+  return x;
+}
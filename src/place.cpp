@@ -41,9 +41,12 @@
 
 using opendp::circuit;
 using opendp::cell;
+using opendp::cell_info;
 using opendp::row;
 using opendp::pixel;
 using opendp::rect;
+using opendp::macro;
+using opendp::sub_region;
 
 using std::cout;
 using std::endl;
@@ -52,6 +55,7 @@ using std::string;
 using std::vector;
 using std::pair;
 using std::sort;
+using std::min;
 using std::make_pair;
 
 double disp(cell* theCell) {
@@ -59,15 +63,20 @@ double disp(cell* theCell) {
          abs(theCell->init_y_coord - theCell->y_coord);
 }
 
-bool SortUpOrder(cell* a, cell* b) {
-  if(a->width * a->height > b->width * b->height)
-    return true;
-  else if(a->width * a->height < b->width * b->height)
-    return false;
-  else
-    return (a->dense_factor > b->dense_factor);
-  // return ( disp(a) > disp(b) );
-}
+// dense_factor lives in the cold cell_infos, looked up only on area ties
+struct SortUpOrder {
+  const vector< cell_info >& infos;
+  SortUpOrder(const vector< cell_info >& cellInfos) : infos(cellInfos) {}
+  bool operator()(cell* a, cell* b) const {
+    if(a->width * a->height > b->width * b->height)
+      return true;
+    else if(a->width * a->height < b->width * b->height)
+      return false;
+    else
+      return (infos[a->id].dense_factor > infos[b->id].dense_factor);
+    // return ( disp(a) > disp(b) );
+  }
+};
 
 bool SortByDisp(cell* a, cell* b) {
   if(a->disp > b->disp)
@@ -76,13 +85,17 @@ bool SortByDisp(cell* a, cell* b) {
     return false;
 }
 
-bool SortByDense(cell* a, cell* b) {
-  // if( a->dense_factor*a->height > b->dense_factor*b->height )
-  if(a->dense_factor > b->dense_factor)
-    return true;
-  else
-    return false;
-}
+struct SortByDense {
+  const vector< cell_info >& infos;
+  SortByDense(const vector< cell_info >& cellInfos) : infos(cellInfos) {}
+  bool operator()(cell* a, cell* b) const {
+    // if( a->dense_factor*a->height > b->dense_factor*b->height )
+    if(infos[a->id].dense_factor > infos[b->id].dense_factor)
+      return true;
+    else
+      return false;
+  }
+};
 
 bool SortDownOrder(cell* a, cell* b) {
   if(a->width * a->height < b->width * b->height)
@@ -93,6 +106,12 @@ bool SortDownOrder(cell* a, cell* b) {
     return (disp(a) > disp(b));
 }
 
+bool SortBySwapKey(cell* a, cell* b) {
+  if(a->type != b->type) return (a->type < b->type);
+  if(a->y_coord != b->y_coord) return (a->y_coord < b->y_coord);
+  return (a->x_coord < b->x_coord);
+}
+
 // SIMPLE PLACEMENT ( NOTICE // FUNCTION ORDER SHOULD BE FIXED )
 void circuit::simple_placement(CMeasure* measure) {
   if(groups.size() > 0) {
@@ -124,21 +143,13 @@ void circuit::simple_placement(CMeasure* measure) {
 
   // naive method placement ( Multi -> single )
   if(groups.size() > 0) {
-    group_cell_placement("init_coord");
+    group_cell_placement(MODE_INIT_COORD);
     cout << " group_cell_placement done .. " << endl;
-    for(int i = 0; i < groups.size(); i++) {
-      group* theGroup = &groups[i];
-      for(int j = 0; j < 3; j++) {
-        int count_a = group_refine(theGroup);
-        int count_b = group_annealing(theGroup);
-        if(count_a < 10 || count_b < 100) break;
-      }
-    }
     if( measure ) {
       measure->stop_clock("Group cell placement");
     }
   }
-  non_group_cell_placement("init_coord");
+  non_group_cell_placement(MODE_INIT_COORD);
   if( measure ) {
     measure->stop_clock("non Group cell placement");
   }
@@ -158,7 +169,7 @@ void circuit::non_group_cell_pre_placement() {
       group* theGroup = &groups[j];
       for(int k = 0; k < theGroup->regions.size(); k++) {
         rect* theRect = &theGroup->regions[k];
-        if(check_overlap(theCell, theRect, "init_coord") == true) {
+        if(check_overlap(theCell, theRect, MODE_INIT_COORD) == true) {
           inGroup = true;
           target = theRect;
         }
@@ -166,7 +177,7 @@ void circuit::non_group_cell_pre_placement() {
     }
     if(inGroup == true) {
       pair< int, int > coord =
-          nearest_coord_to_rect_boundary(theCell, target, "init_coord");
+          nearest_coord_to_rect_boundary(theCell, target, MODE_INIT_COORD);
       if(map_move(theCell, coord.first, coord.second) == true)
         theCell->hold = true;
     }
@@ -185,8 +196,8 @@ void circuit::group_cell_pre_placement() {
       rect* target;
       for(int k = 0; k < theGroup->regions.size(); k++) {
         rect* theRect = &theGroup->regions[k];
-        if(check_inside(theCell, theRect, "init_coord") == true) inGroup = true;
-        int temp_dist = dist_for_rect(theCell, theRect, "init_coord");
+        if(check_inside(theCell, theRect, MODE_INIT_COORD) == true) inGroup = true;
+        int temp_dist = dist_for_rect(theCell, theRect, MODE_INIT_COORD);
         if(temp_dist < dist) {
           dist = temp_dist;
           target = theRect;
@@ -194,7 +205,7 @@ void circuit::group_cell_pre_placement() {
       }
       if(inGroup == false) {
         pair< int, int > coord =
-            nearest_coord_to_rect_boundary(theCell, target, "init_coord");
+            nearest_coord_to_rect_boundary(theCell, target, MODE_INIT_COORD);
         if(map_move(theCell, coord.first, coord.second) == true)
           theCell->hold = true;
       }
@@ -203,7 +214,12 @@ void circuit::group_cell_pre_placement() {
   return;
 }
 
-void circuit::non_group_cell_placement(string mode) {
+void circuit::non_group_cell_placement(coord_mode mode) {
+  if(strip_placement == true && sub_regions.size() > 1) {
+    strip_cell_placement(mode);
+    return;
+  }
+
   vector< cell* > cell_list;
   cell_list.reserve(cells.size());
 
@@ -213,7 +229,7 @@ void circuit::non_group_cell_placement(string mode) {
 
     cell_list.push_back(theCell);
   }
-  sort(cell_list.begin(), cell_list.end(), SortUpOrder);
+  sort(cell_list.begin(), cell_list.end(), SortUpOrder(cell_infos));
 
   for(int i = 0; i < cell_list.size(); i++) {
     cell* theCell = cell_list[i];
@@ -231,77 +247,177 @@ void circuit::non_group_cell_placement(string mode) {
   return;
 }
 
-void circuit::group_cell_placement(string mode) {
-  group_cell_placement(mode, "INIT");
+// strip interiors are placed concurrently, each confined to its own grid
+// segment, then the halo cells and interior failures are placed serially.
+// strips never see each other, so the result does not depend on num_cpu
+void circuit::strip_cell_placement(coord_mode mode) {
+  int col_num = grid.col_num;
+  vector< int > begins(sub_regions.size(), 0);
+  for(int j = 1; j < sub_regions.size(); j++) {
+    begins[j] = min(col_num, (int)floor(sub_regions[j].boundary.xLL / wsite));
+  }
+  grid.set_segments(begins);
+
+  vector< vector< cell* > > halos(sub_regions.size());
+#pragma omp parallel for schedule(dynamic) num_threads(num_cpu)
+  for(int j = 0; j < sub_regions.size(); j++) {
+    int col_begin = (j == 0) ? 0 : begins[j] + STRIP_HALO;
+    int col_end =
+        (j + 1 == sub_regions.size()) ? col_num : begins[j + 1] - STRIP_HALO;
+    strip_interior_placement(&sub_regions[j], col_begin, col_end, mode,
+                             halos[j]);
+  }
+  grid.set_segments(vector< int >(1, 0));
+
+  vector< cell* > cell_list;
+  for(int j = 0; j < halos.size(); j++) {
+    cell_list.insert(cell_list.end(), halos[j].begin(), halos[j].end());
+  }
+  sort(cell_list.begin(), cell_list.end(), SortUpOrder(cell_infos));
+
+  for(int i = 0; i < cell_list.size(); i++) {
+    cell* theCell = cell_list[i];
+    macro* theMacro = &macros[theCell->type];
+    if(theMacro->isMulti == true)
+      if(map_move(theCell, mode) == false) shift_move(theCell, mode);
+  }
+  for(int i = 0; i < cell_list.size(); i++) {
+    cell* theCell = cell_list[i];
+    macro* theMacro = &macros[theCell->type];
+    if(theMacro->isMulti == false)
+      if(map_move(theCell, mode) == false) shift_move(theCell, mode);
+  }
+  return;
 }
 
-void circuit::group_cell_placement(string mode, string mode2) {
-  for(int i = 0; i < groups.size(); i++) {
-    bool single_pass = true;
-    bool multi_pass = true;
+// places the cells of theSub lying in sites [col_begin, col_end) without
+// leaving them ; the rest goes to halo
+void circuit::strip_interior_placement(sub_region* theSub, int col_begin,
+                                       int col_end, coord_mode mode,
+                                       vector< cell* >& halo) {
+  vector< cell* > cell_list;
+  for(int i = 0; i < theSub->siblings.size(); i++) {
+    cell* theCell = theSub->siblings[i];
+    if(theCell->isFixed || theCell->inGroup || theCell->isPlaced) continue;
+    cell_list.push_back(theCell);
+  }
+  sort(cell_list.begin(), cell_list.end(), SortUpOrder(cell_infos));
+
+  for(int pass = 0; pass < 2; pass++) {
+    for(int i = 0; i < cell_list.size(); i++) {
+      cell* theCell = cell_list[i];
+      macro* theMacro = &macros[theCell->type];
+      // multi-deck cells first
+      if(theMacro->isMulti != (pass == 0)) continue;
+
+      int x = INT_MAX;
+      int y = INT_MAX;
+      if(mode == MODE_INIT_COORD) {
+        x = theCell->init_x_coord;
+        y = theCell->init_y_coord;
+      }
+      else if(mode == MODE_COORD) {
+        x = theCell->x_coord;
+        y = theCell->y_coord;
+      }
+      else {
+        x = theCell->x_pos * wsite;
+        y = theCell->y_pos * rowHeight;
+      }
+
+      int x_pos = (int)floor(x / wsite + 0.5);
+      pair< bool, pixel > myPixel(false, pixel());
+      if(x_pos >= col_begin && x_pos + theCell->width / wsite <= col_end)
+        myPixel = diamond_search(theCell, x, y, col_begin, col_end);
+      if(myPixel.first == true)
+        paint_pixel(theCell, myPixel.second.x_pos, myPixel.second.y_pos);
+      else
+        halo.push_back(theCell);
+    }
+  }
+  return;
+}
 
+// fences own disjoint pixels and gap buckets, so each group is placed,
+// refined and annealed as an independent task
+void circuit::group_cell_placement(coord_mode mode) {
+#pragma omp parallel for schedule(dynamic) num_threads(num_cpu)
+  for(int i = 0; i < groups.size(); i++) {
     group* theGroup = &groups[i];
-    vector< cell* > cell_list;
-    cell_list.reserve(cells.size());
-    for(int j = 0; j < theGroup->siblings.size(); j++) {
-      cell* theCell = theGroup->siblings[j];
-      if(theCell->isFixed || theCell->isPlaced) continue;
-      cell_list.push_back(theCell);
+    group_cell_placement(theGroup, mode);
+    for(int j = 0; j < 3; j++) {
+      int count_a = group_refine(theGroup);
+      int count_b = group_annealing(theGroup);
+      if(count_a < 10 || count_b < 100) break;
     }
-    sort(cell_list.begin(), cell_list.end(), SortUpOrder);
-    // sort( cell_list.begin(), cell_list.end(), SortByDense);
-    // place multi-deck cells on each group region
+  }
+  return;
+}
+
+void circuit::group_cell_placement(group* theGroup, coord_mode mode) {
+  bool single_pass = true;
+  bool multi_pass = true;
+
+  vector< cell* > cell_list;
+  cell_list.reserve(theGroup->siblings.size());
+  for(int j = 0; j < theGroup->siblings.size(); j++) {
+    cell* theCell = theGroup->siblings[j];
+    if(theCell->isFixed || theCell->isPlaced) continue;
+    cell_list.push_back(theCell);
+  }
+  sort(cell_list.begin(), cell_list.end(), SortUpOrder(cell_infos));
+  // sort( cell_list.begin(), cell_list.end(), SortByDense(cell_infos));
+  // place multi-deck cells on each group region
+  for(int j = 0; j < cell_list.size(); j++) {
+    cell* theCell = cell_list[j];
+    if(theCell->isFixed || theCell->isPlaced) continue;
+    assert(theCell->inGroup == true);
+    macro* theMacro = &macros[theCell->type];
+    if(theMacro->isMulti == true) {
+      multi_pass = map_move(theCell, mode);
+      if(multi_pass == false) {
+        cout << "map_move fail" << endl;
+        break;
+      }
+    }
+  }
+  // cout << "Group util : " << theGroup->util << endl;
+  if(multi_pass == true) {
+    //				cout << " Group : " << theGroup->name <<
+    //" multi-deck placement done - ";
+    // place single-deck cells on each group region
     for(int j = 0; j < cell_list.size(); j++) {
       cell* theCell = cell_list[j];
       if(theCell->isFixed || theCell->isPlaced) continue;
       assert(theCell->inGroup == true);
       macro* theMacro = &macros[theCell->type];
-      if(theMacro->isMulti == true) {
-        multi_pass = map_move(theCell, mode);
-        if(multi_pass == false) {
-          cout << "map_move fail" << endl;
+      if(theMacro->isMulti == false) {
+        single_pass = map_move(theCell, mode);
+        if(single_pass == false) {
+          //						cout << "map_move fail" <<
+          //endl;
           break;
         }
       }
     }
-    // cout << "Group util : " << theGroup->util << endl;
-    if(multi_pass == true) {
-      //				cout << " Group : " << theGroup->name <<
-      //" multi-deck placement done - ";
-      // place single-deck cells on each group region
-      for(int j = 0; j < cell_list.size(); j++) {
-        cell* theCell = cell_list[j];
-        if(theCell->isFixed || theCell->isPlaced) continue;
-        assert(theCell->inGroup == true);
-        macro* theMacro = &macros[theCell->type];
-        if(theMacro->isMulti == false) {
-          single_pass = map_move(theCell, mode);
-          if(single_pass == false) {
-            //						cout << "map_move fail" <<
-            //endl;
-            break;
-          }
-        }
-      }
+  }
+  //			if( single_pass == true )
+  //				cout << "single-deck placement done" << endl;
+
+  if(single_pass == false || multi_pass == false) {
+    // Erase group cells
+    for(int j = 0; j < theGroup->siblings.size(); j++) {
+      cell* theCell = theGroup->siblings[j];
+      erase_pixel(theCell);
     }
-    //			if( single_pass == true )
-    //				cout << "single-deck placement done" << endl;
-
-    if(single_pass == false || multi_pass == false) {
-      // Erase group cells
-      for(int j = 0; j < theGroup->siblings.size(); j++) {
-        cell* theCell = theGroup->siblings[j];
-        erase_pixel(theCell);
-      }
-      //				cout << "erase done" << endl;
+    //				cout << "erase done" << endl;
 
-      // determine brick placement by utilization
-      if(theGroup->util > 0.95) {
-        brick_placement_1(theGroup);
-      }
-      else {
-        brick_placement_2(theGroup);
-      }
+    // determine brick placement by utilization
+    if(theGroup->util > 0.95) {
+      brick_placement_1(theGroup);
+    }
+    else {
+      brick_placement_2(theGroup);
     }
   }
   return;
@@ -354,7 +470,7 @@ void circuit::brick_placement_1(group* theGroup) {
     bool valid = map_move(theCell, x_tar, y_tar);
     if(valid == false) {
       cout << "== WARNING !! ==" << endl;
-      cout << " Can't place single ( brick place 1 ) " << theCell->name << endl;
+      cout << " Can't place single ( brick place 1 ) " << cell_name(theCell) << endl;
     }
   }
   return;
@@ -367,7 +483,7 @@ void circuit::brick_placement_2(group* theGroup) {
 
   for(int i = 0; i < theGroup->siblings.size(); i++) {
     cell* theCell = theGroup->siblings[i];
-    rect theRect = theGroup->regions[theCell->region];
+    rect theRect = theGroup->regions[cell_infos[theCell->id].region];
     int x_tar = 0;
     int y_tar = 0;
     if(theCell->init_x_coord > (theRect.xLL + theRect.xUR) / 2)
@@ -392,7 +508,7 @@ void circuit::brick_placement_2(group* theGroup) {
   for(int i = 0; i < sort_by_dist.size(); i++) {
     cell* theCell = sort_by_dist[i].second;
     if(theCell->hold == true) continue;
-    rect theRect = theGroup->regions[theCell->region];
+    rect theRect = theGroup->regions[cell_infos[theCell->id].region];
     int x_tar = 0;
     int y_tar = 0;
     if(theCell->init_x_coord > (theRect.xLL + theRect.xUR) / 2)
@@ -406,7 +522,7 @@ void circuit::brick_placement_2(group* theGroup) {
     bool valid = map_move(theCell, x_tar, y_tar);
     if(valid == false) {
       cout << "== WARNING !! ==" << endl;
-      cout << " Can't place single ( brick place 2 ) " << theCell->name << endl;
+      cout << " Can't place single ( brick place 2 ) " << cell_name(theCell) << endl;
     }
   }
 
@@ -434,38 +550,89 @@ int circuit::group_refine(group* theGroup) {
     cell* theCell = sort_by_disp[i].second;
     if(theCell->hold == true) continue;
 
-    if(refine_move(theCell, "init_coord") == true) count++;
+    if(refine_move(theCell, MODE_INIT_COORD) == true) count++;
   }
   // cout << " Group refine : " << count << endl;
   return count;
 }
 
 int circuit::group_annealing(group* theGroup) {
-  srand(777);
-  // srand(time(NULL));
-  int count = 0;
-
-  for(int i = 0; i < 1000 * theGroup->siblings.size(); i++) {
-    cell* cellA = theGroup->siblings[rand() % theGroup->siblings.size()];
-    cell* cellB = theGroup->siblings[rand() % theGroup->siblings.size()];
-
-    if(cellA->hold == true || cellB->hold == true) continue;
+  return swap_annealing(theGroup->siblings, 777);
+}
 
-    if(swap_cell(cellA, cellB) == true) count++;
+int circuit::non_group_annealing() {
+  vector< cell* > cell_list;
+  cell_list.reserve(cells.size());
+  for(int i = 0; i < cells.size(); i++) {
+    cell* theCell = &cells[i];
+    if(theCell->inGroup == true) continue;
+    cell_list.push_back(theCell);
   }
-  // cout << " swap cell count : " << count << endl;
-  return count;
+  return swap_annealing(cell_list, 777);
 }
 
-int circuit::non_group_annealing() {
-  srand(777);
-  int count = 0;
-  for(int i = 0; i < 100 * cells.size(); i++) {
-    cell* cellA = &cells[rand() % cells.size()];
-    cell* cellB = &cells[rand() % cells.size()];
-    if(cellA->hold == true || cellB->hold == true) continue;
+// Proposes same-type swaps only. A swap can shorten cellA's displacement only
+// if the partner sits closer to cellA's initial location than cellA does, so
+// partners are drawn from that diamond. Each call owns its generator, so
+// concurrent groups stay deterministic.
+int circuit::swap_annealing(const vector< cell* >& cell_list, unsigned seed) {
+  vector< cell* > cands;
+  cands.reserve(cell_list.size());
+  for(int i = 0; i < cell_list.size(); i++) {
+    cell* theCell = cell_list[i];
+    if(theCell->isFixed || theCell->hold || !theCell->isPlaced) continue;
+    cands.push_back(theCell);
+  }
+  if(cands.size() < 2) return 0;
+
+  // ( type, y_coord, x_coord ) order : swapping two cells swaps their slots
+  sort(cands.begin(), cands.end(), SortBySwapKey);
+
+  // [type_begin, type_end) of each slot's macro type
+  vector< pair< int, int > > type_range(cands.size());
+  for(int i = 0; i < cands.size();) {
+    int j = i;
+    while(j < cands.size() && cands[j]->type == cands[i]->type) j++;
+    for(int k = i; k < j; k++) type_range[k] = make_pair(i, j);
+    i = j;
+  }
 
-    if(swap_cell(cellA, cellB) == true) count++;
+  auto before = [](cell* theCell, const pair< int, int >& key) {
+    return make_pair(theCell->y_coord, theCell->x_coord) < key;
+  };
+  int row_height = static_cast< int >(rowHeight);
+  std::minstd_rand rng(seed);
+  int count = 0;
+  for(long long iter = 0;
+      iter < (long long)SWAP_MOVES_PER_CELL * cands.size(); iter++) {
+    int i = rng() % cands.size();
+    cell* cellA = cands[i];
+    int radius = disp(cellA);
+    if(radius == 0 || type_range[i].second - type_range[i].first < 2)
+      continue;
+
+    // random row of the diamond, then a random partner inside its x window
+    int row_lo = std::max(
+        0, (cellA->init_y_coord - radius + row_height - 1) / row_height);
+    int row_hi = (cellA->init_y_coord + radius) / row_height;
+    if(row_hi < row_lo) continue;
+    int y = (row_lo + rng() % (row_hi - row_lo + 1)) * row_height;
+    int half = radius - abs(y - cellA->init_y_coord);
+    if(half <= 0) continue;
+
+    vector< cell* >::iterator first = cands.begin() + type_range[i].first;
+    vector< cell* >::iterator last = cands.begin() + type_range[i].second;
+    first = std::lower_bound(first, last,
+                             make_pair(y, cellA->init_x_coord - half), before);
+    last = std::lower_bound(first, last,
+                            make_pair(y, cellA->init_x_coord + half), before);
+    if(first == last) continue;
+
+    int j = (first - cands.begin()) + rng() % (last - first);
+    if(swap_cell(cellA, cands[j]) == true) {
+      std::swap(cands[i], cands[j]);
+      count++;
+    }
   }
   // cout << " swap cell count : " << count << endl;
   return count;
@@ -489,7 +656,7 @@ int circuit::non_group_refine() {
   for(int i = 0; i < sort_by_disp.size() / 50; i++) {
     cell* theCell = sort_by_disp[i].second;
     if(theCell->hold == true) continue;
-    if(refine_move(theCell, "init_coord") == true) count++;
+    if(refine_move(theCell, MODE_INIT_COORD) == true) count++;
   }
   // cout << " nonGroup refine : " << count << endl;
   return count;
@@ -0,0 +1,1043 @@
+/////////////////////////////////////////////////////////////////////////////
+// Authors: SangGi Do(sanggido@unist.ac.kr), Mingyu Woo(mwoo@eng.ucsd.edu)
+//          (respective Ph.D. advisors: Seokhyeong Kang, Andrew B. Kahng)
+//
+//          Original parsing structure was made by Myung-Chul Kim (IBM).
+//
+// BSD 3-Clause License
+//
+// Copyright (c) 2018, SangGi Do and Mingyu Woo
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of source code must retain the above copyright notice, this
+//   list of conditions and the following disclaimer.
+//
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+//
+// * Neither the name of the copyright holder nor the names of its
+//   contributors may be used to endorse or promote products derived from
+//   this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+///////////////////////////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <type_traits>
+#include "circuit.h"
+
+// Binary snapshot of an initialized circuit ( save_snapshot / load_snapshot )
+//
+// file : snap_header | snap_section[SNAP_NUM_SECTIONS] | payloads
+// Payloads are 8 byte aligned arrays of fixed width records that hold no
+// pointers : names are ( offset, length ) into SNAP_STRINGS, variable length
+// lists are ( begin, count ) into the SNAP_UINTS / SNAP_RECTS pools, and
+// cells, pins and nets refer to each other by index. A reader maps the file
+// and copies the arrays out; the version and record sizes in the header
+// reject images from another build.
+//
+// The LEF cache ( ReadLef with lef_cache_dir set ) uses the same format
+// with its own magic, holding only the macro, site and layer tables. It is
+// named after a hash of the LEF files' contents.
+
+#define SNAPSHOT_MAGIC "OPENDPSN"
+#define LEF_CACHE_MAGIC "OPENDPLC"
+#define SNAPSHOT_VERSION 4
+#define SNAPSHOT_ENDIAN 0x01020304u
+
+using opendp::circuit;
+using opendp::cell;
+using opendp::pin;
+using opendp::net;
+using opendp::row;
+using opendp::rect;
+using opendp::site;
+using opendp::layer;
+using opendp::macro;
+using opendp::macro_pin;
+using opendp::group;
+using opendp::def_component;
+
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+using std::pair;
+using std::make_pair;
+
+namespace {
+
+enum snap_section_id {
+  SNAP_STRINGS,
+  SNAP_SCALARS,
+  SNAP_UINTS,
+  SNAP_RECTS,
+  SNAP_MACROS,
+  SNAP_MACRO_PINS,
+  SNAP_CELLS,
+  SNAP_PINS,
+  SNAP_NETS,
+  SNAP_ROWS,
+  SNAP_PREVROWS,
+  SNAP_GROUPS,
+  SNAP_EDGE_SPACING,
+  SNAP_DEF_COMPONENTS,
+  SNAP_DEF_TEXT,
+  SNAP_GRID_CELL,
+  SNAP_GRID_GROUP,
+  SNAP_GRID_VALID,
+  SNAP_SITES,
+  SNAP_LAYERS,
+  SNAP_NUM_SECTIONS
+};
+
+struct snap_section {
+  uint64_t offset; /* from the start of the file */
+  uint64_t count;
+  uint32_t elem_size;
+  uint32_t pad;
+};
+
+struct snap_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t endian;
+  uint32_t num_sections;
+  uint32_t pad;
+  uint64_t file_size;
+};
+
+struct snap_str {
+  uint64_t offset;
+  uint64_t len;
+};
+
+struct snap_list {
+  uint32_t begin;
+  uint32_t count;
+};
+
+struct snap_scalars {
+  double design_util, total_mArea, total_fArea, designArea;
+  double rowHeight, lx, rx, by, ty;
+  double minVddCoordiY, max_utilization, displacement, max_disp_const;
+  double LEFManufacturingGrid;
+  rect die, core;
+  int64_t def_comps_begin, def_comps_end;
+  int32_t wsite, max_cell_height, initial_power, GROUP_IGNORE;
+  uint32_t num_fixed_nodes, DEFdist2Microns;
+  int32_t grid_rows, grid_cols;
+  snap_str in_def_name, out_def_name, benchmark, design_name;
+  snap_str DEFVersion, DEFDelimiter, DEFBusCharacters;
+  snap_str LEFVersion, LEFNamesCaseSensitive, LEFDelimiter, LEFBusCharacters;
+};
+
+struct snap_macro {
+  snap_str name, type;
+  double xOrig, yOrig, width, height;
+  int32_t isFlop, isMulti, edgetypeLeft, edgetypeRight, top_power, pad;
+  snap_list sites, obses, pins;
+};
+
+struct snap_macro_pin {
+  snap_str name, direction, shape;
+  snap_list port, layer;
+};
+
+struct snap_cell {
+  snap_str name;
+  double width, height, dense_factor;
+  int32_t x_coord, y_coord, init_x_coord, init_y_coord, x_pos, y_pos, disp;
+  uint32_t type, region, group, cellorient;
+  uint8_t isFixed, isPlaced, inGroup, hold;
+};
+
+struct snap_pin {
+  snap_str name; /* PI/PO only */
+  double x_coord, y_coord, x_offset, y_offset;
+  uint32_t owner, mpin, net, type;
+  uint8_t isFlopInput, isFlopCkPort, isFixed, pad[5];
+};
+
+struct snap_net {
+  snap_str name;
+  uint32_t source;
+  snap_list sinks;
+  uint32_t pad;
+};
+
+struct snap_row {
+  snap_str name;
+  uint32_t site;
+  int32_t origX, origY, stepX, stepY, numSites, siteorient, top_power;
+};
+
+struct snap_group {
+  snap_str name, type, tag;
+  rect boundary;
+  double util;
+  snap_list regions, siblings;
+};
+
+struct snap_edge_spacing {
+  int32_t left, right;
+  double spacing;
+};
+
+struct snap_def_component {
+  uint64_t text;
+  uint32_t cell, status, nets_len, extra_len;
+};
+
+struct snap_site {
+  snap_str name, type;
+  snap_str symmetries; /* space separated */
+  double width, height;
+};
+
+struct snap_layer {
+  snap_str name, type, direction;
+  double xPitch, yPitch, xOffset, yOffset, width, maxWidth;
+};
+
+static_assert(std::is_trivially_copyable< rect >::value,
+              "rect is stored as is");
+
+// builds the image in memory, then writes it with one call
+class snap_writer {
+ public:
+  snap_writer(const char* who = "save_snapshot",
+              const char* magic = SNAPSHOT_MAGIC)
+      : who(who), magic(magic), sections(SNAP_NUM_SECTIONS) {}
+
+  snap_str str(const string& s) {
+    snap_str ref = {strings.size(), s.size()};
+    strings += s;
+    return ref;
+  }
+  snap_str str(const opendp::name_ref& s) {
+    snap_str ref = {strings.size(), s.size()};
+    strings.append(s.c_str(), s.size());
+    return ref;
+  }
+  snap_list uint_list(const unsigned* begin, size_t count) {
+    snap_list ref = {(uint32_t)uints.size(), (uint32_t)count};
+    uints.insert(uints.end(), begin, begin + count);
+    return ref;
+  }
+  snap_list rect_list(const vector< rect >& list) {
+    snap_list ref = {(uint32_t)rects.size(), (uint32_t)list.size()};
+    rects.insert(rects.end(), list.begin(), list.end());
+    return ref;
+  }
+
+  template < class T >
+  void put(snap_section_id id, const vector< T >& records) {
+    put(id, records.data(), records.size(), sizeof(T));
+  }
+  void put(snap_section_id id, const void* data, size_t count,
+           size_t elem_size) {
+    vector< char >& payload = payloads[id];
+    payload.assign((const char*)data, (const char*)data + count * elem_size);
+    sections[id].count = count;
+    sections[id].elem_size = elem_size;
+  }
+
+  bool write(const string& file) {
+    put(SNAP_STRINGS, strings.data(), strings.size(), 1);
+    put(SNAP_UINTS, uints);
+    put(SNAP_RECTS, rects);
+
+    snap_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, 8);
+    header.version = SNAPSHOT_VERSION;
+    header.endian = SNAPSHOT_ENDIAN;
+    header.num_sections = SNAP_NUM_SECTIONS;
+
+    uint64_t offset = sizeof(snap_header) +
+                      SNAP_NUM_SECTIONS * sizeof(snap_section);
+    for(int i = 0; i < SNAP_NUM_SECTIONS; i++) {
+      offset = (offset + 7) & ~(uint64_t)7;
+      sections[i].offset = offset;
+      offset += payloads[i].size();
+    }
+    header.file_size = offset;
+
+    FILE* out = fopen(file.c_str(), "wb");
+    if(!out) {
+      cerr << who << ":: cannot open '" << file << "' for writing. " << endl;
+      return false;
+    }
+    static const char zeros[8] = {0};
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(sections.data(), sizeof(snap_section), SNAP_NUM_SECTIONS, out);
+    uint64_t written = sizeof(snap_header) +
+                       SNAP_NUM_SECTIONS * sizeof(snap_section);
+    for(int i = 0; i < SNAP_NUM_SECTIONS; i++) {
+      fwrite(zeros, 1, sections[i].offset - written, out);
+      fwrite(payloads[i].data(), 1, payloads[i].size(), out);
+      written = sections[i].offset + payloads[i].size();
+    }
+    bool ok = (ferror(out) == 0);
+    ok = (fclose(out) == 0) && ok;
+    if(!ok) cerr << who << ":: write to '" << file << "' failed. " << endl;
+    return ok;
+  }
+
+ private:
+  const char* who;
+  const char* magic;
+  vector< snap_section > sections;
+  vector< char > payloads[SNAP_NUM_SECTIONS];
+  string strings;
+  vector< unsigned > uints;
+  vector< rect > rects;
+};
+
+// read side : checked views into the mapped image
+class snap_reader {
+ public:
+  snap_reader(const char* who = "load_snapshot",
+              const char* magic = SNAPSHOT_MAGIC,
+              const char* what = "a snapshot")
+      : who(who), magic(magic), what(what), base(NULL), size(0) {}
+  ~snap_reader() {
+    if(base) munmap((void*)base, size);
+  }
+
+  bool open(const string& file) {
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if(fd < 0) {
+      cerr << who << ":: cannot open '" << file << "'. " << endl;
+      return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(snap_header)) {
+      cerr << who << ":: '" << file << "' is not " << what << ". " << endl;
+      ::close(fd);
+      return false;
+    }
+    size = st.st_size;
+    void* addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(addr == MAP_FAILED) {
+      cerr << who << ":: cannot map '" << file << "'. " << endl;
+      return false;
+    }
+    base = (const char*)addr;
+#ifdef MADV_WILLNEED
+    madvise(addr, size, MADV_WILLNEED);
+#endif
+
+    const snap_header* header = (const snap_header*)base;
+    if(memcmp(header->magic, magic, 8) != 0 ||
+       header->endian != SNAPSHOT_ENDIAN) {
+      cerr << who << ":: '" << file << "' is not " << what << ". " << endl;
+      return false;
+    }
+    if(header->file_size != size) {
+      cerr << who << ":: '" << file << "' is truncated. " << endl;
+      return false;
+    }
+    if(header->version != SNAPSHOT_VERSION ||
+       header->num_sections != SNAP_NUM_SECTIONS) {
+      cerr << who << ":: '" << file << "' has version "
+           << header->version << ", expected " << SNAPSHOT_VERSION << ". "
+           << endl;
+      return false;
+    }
+    sections = (const snap_section*)(base + sizeof(snap_header));
+    for(int i = 0; i < SNAP_NUM_SECTIONS; i++) {
+      const snap_section& s = sections[i];
+      if(s.offset > size || s.count * s.elem_size > size - s.offset) {
+        cerr << who << ":: '" << file << "' is truncated. " << endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // records of one section, NULL if the record layout does not match
+  template < class T >
+  const T* get(snap_section_id id, size_t* count) const {
+    const snap_section& s = sections[id];
+    *count = s.count;
+    if(s.count != 0 && s.elem_size != sizeof(T)) return NULL;
+    return (const T*)(base + s.offset);
+  }
+
+  string str(const snap_str& ref) const {
+    const snap_section& s = sections[SNAP_STRINGS];
+    if(ref.offset > s.count || ref.len > s.count - ref.offset) return "";
+    return string(base + s.offset + ref.offset, ref.len);
+  }
+  // interns straight from the mapping
+  opendp::name_ref name(const snap_str& ref, opendp::name_pool& pool) const {
+    const snap_section& s = sections[SNAP_STRINGS];
+    if(ref.offset > s.count || ref.len > s.count - ref.offset)
+      return pool.intern("", 0);
+    return pool.intern(base + s.offset + ref.offset, ref.len);
+  }
+
+ private:
+  const char* who;
+  const char* magic;
+  const char* what;
+  const char* base;
+  size_t size;
+  const snap_section* sections;
+};
+
+bool snap_corrupt(const string& file, const char* who = "load_snapshot") {
+  cerr << who << ":: '" << file << "' is corrupt. " << endl;
+  return false;
+}
+
+bool snap_in_pool(const snap_list& l, size_t pool) {
+  return l.begin <= pool && l.count <= pool - l.begin;
+}
+
+// macro table, shared by the snapshot and the LEF cache
+void snap_put_macros(snap_writer& w, vector< macro >& macros) {
+  vector< snap_macro > snap_macros(macros.size());
+  vector< snap_macro_pin > snap_macro_pins;
+  for(int i = 0; i < macros.size(); i++) {
+    macro* theMacro = &macros[i];
+    snap_macro& m = snap_macros[i];
+    memset(&m, 0, sizeof(m));
+    m.name = w.str(theMacro->name);
+    m.type = w.str(theMacro->type);
+    m.xOrig = theMacro->xOrig;
+    m.yOrig = theMacro->yOrig;
+    m.width = theMacro->width;
+    m.height = theMacro->height;
+    m.isFlop = theMacro->isFlop;
+    m.isMulti = theMacro->isMulti;
+    m.edgetypeLeft = theMacro->edgetypeLeft;
+    m.edgetypeRight = theMacro->edgetypeRight;
+    m.top_power = theMacro->top_power;
+    m.sites = w.uint_list(theMacro->sites.data(), theMacro->sites.size());
+    m.obses = w.rect_list(theMacro->obses);
+    m.pins.begin = snap_macro_pins.size();
+    for(auto& it : theMacro->pins) {
+      snap_macro_pin p;
+      p.name = w.str(it.name);
+      p.direction = w.str(it.direction);
+      p.shape = w.str(it.shape);
+      p.port = w.rect_list(it.port);
+      p.layer = w.uint_list(it.layer.data(), it.layer.size());
+      snap_macro_pins.push_back(p);
+    }
+    m.pins.count = snap_macro_pins.size() - m.pins.begin;
+  }
+  w.put(SNAP_MACROS, snap_macros);
+  w.put(SNAP_MACRO_PINS, snap_macro_pins);
+}
+
+bool snap_get_macros(const snap_reader& r, circuit* ckt, const string& file,
+                     const char* who) {
+  size_t n_uint, n_rect, n_macro, n_mpin;
+  const unsigned* uints = r.get< unsigned >(SNAP_UINTS, &n_uint);
+  const rect* rects = r.get< rect >(SNAP_RECTS, &n_rect);
+  const snap_macro* sm = r.get< snap_macro >(SNAP_MACROS, &n_macro);
+  const snap_macro_pin* smp =
+      r.get< snap_macro_pin >(SNAP_MACRO_PINS, &n_mpin);
+  if(!uints || !rects || !sm || !smp) {
+    cerr << who << ":: '" << file << "' record layout mismatch. " << endl;
+    return false;
+  }
+  ckt->macros.resize(n_macro);
+  for(int i = 0; i < n_macro; i++) {
+    const snap_macro& m = sm[i];
+    macro* theMacro = &ckt->macros[i];
+    if(!snap_in_pool(m.sites, n_uint) || !snap_in_pool(m.obses, n_rect) ||
+       !snap_in_pool(m.pins, n_mpin))
+      return snap_corrupt(file, who);
+    theMacro->name = r.name(m.name, ckt->names);
+    theMacro->type = r.str(m.type);
+    theMacro->xOrig = m.xOrig;
+    theMacro->yOrig = m.yOrig;
+    theMacro->width = m.width;
+    theMacro->height = m.height;
+    theMacro->isFlop = m.isFlop;
+    theMacro->isMulti = m.isMulti;
+    theMacro->edgetypeLeft = m.edgetypeLeft;
+    theMacro->edgetypeRight = m.edgetypeRight;
+    theMacro->top_power = static_cast< opendp::power >(m.top_power);
+    theMacro->sites.assign(uints + m.sites.begin,
+                           uints + m.sites.begin + m.sites.count);
+    theMacro->obses.assign(rects + m.obses.begin,
+                           rects + m.obses.begin + m.obses.count);
+    for(int j = m.pins.begin; j < m.pins.begin + m.pins.count; j++) {
+      const snap_macro_pin& p = smp[j];
+      if(!snap_in_pool(p.port, n_rect) || !snap_in_pool(p.layer, n_uint))
+        return snap_corrupt(file, who);
+      macro_pin& thePin = *theMacro->locateOrCreatePin(r.str(p.name));
+      thePin.direction = r.str(p.direction);
+      thePin.shape = r.str(p.shape);
+      thePin.port.assign(rects + p.port.begin,
+                         rects + p.port.begin + p.port.count);
+      thePin.layer.assign(uints + p.layer.begin,
+                          uints + p.layer.begin + p.layer.count);
+    }
+    ckt->macro2id[theMacro->name] = i;
+  }
+  return true;
+}
+
+}  // namespace
+
+bool circuit::save_snapshot(const string& file) {
+  // the image always carries the nets
+  load_nets();
+  snap_writer w;
+
+  snap_scalars sc;
+  memset(&sc, 0, sizeof(sc));
+  sc.design_util = design_util;
+  sc.total_mArea = total_mArea;
+  sc.total_fArea = total_fArea;
+  sc.designArea = designArea;
+  sc.rowHeight = rowHeight;
+  sc.lx = lx;
+  sc.rx = rx;
+  sc.by = by;
+  sc.ty = ty;
+  sc.minVddCoordiY = minVddCoordiY;
+  sc.max_utilization = max_utilization;
+  sc.displacement = displacement;
+  sc.max_disp_const = max_disp_const;
+  sc.LEFManufacturingGrid = LEFManufacturingGrid;
+  sc.die = die;
+  sc.core = core;
+  sc.def_comps_begin = def_comps_begin;
+  sc.def_comps_end = def_comps_end;
+  sc.wsite = wsite;
+  sc.max_cell_height = max_cell_height;
+  sc.initial_power = initial_power;
+  sc.GROUP_IGNORE = GROUP_IGNORE;
+  sc.num_fixed_nodes = num_fixed_nodes;
+  sc.DEFdist2Microns = DEFdist2Microns;
+  sc.grid_rows = grid.row_num;
+  sc.grid_cols = grid.col_num;
+  sc.in_def_name = w.str(in_def_name);
+  sc.out_def_name = w.str(out_def_name);
+  sc.benchmark = w.str(benchmark);
+  sc.design_name = w.str(design_name);
+  sc.DEFVersion = w.str(DEFVersion);
+  sc.DEFDelimiter = w.str(DEFDelimiter);
+  sc.DEFBusCharacters = w.str(DEFBusCharacters);
+  sc.LEFVersion = w.str(LEFVersion);
+  sc.LEFNamesCaseSensitive = w.str(LEFNamesCaseSensitive);
+  sc.LEFDelimiter = w.str(LEFDelimiter);
+  sc.LEFBusCharacters = w.str(LEFBusCharacters);
+  w.put(SNAP_SCALARS, &sc, 1, sizeof(sc));
+  snap_put_macros(w, macros);
+
+
+  vector< snap_cell > snap_cells(cells.size());
+  for(int i = 0; i < cells.size(); i++) {
+    cell* theCell = &cells[i];
+    cell_info* theInfo = &cell_infos[i];
+    snap_cell& c = snap_cells[i];
+    memset(&c, 0, sizeof(c));
+    c.name = w.str(theInfo->name);
+    c.width = theCell->width;
+    c.height = theCell->height;
+    c.dense_factor = theInfo->dense_factor;
+    c.disp = theCell->disp;
+    c.x_coord = theCell->x_coord;
+    c.y_coord = theCell->y_coord;
+    c.init_x_coord = theCell->init_x_coord;
+    c.init_y_coord = theCell->init_y_coord;
+    c.x_pos = theCell->x_pos;
+    c.y_pos = theCell->y_pos;
+    c.type = theCell->type;
+    c.region = theInfo->region;
+    c.group = theCell->group;
+    c.cellorient = theCell->cellorient;
+    c.isFixed = theCell->isFixed;
+    c.isPlaced = theCell->isPlaced;
+    c.inGroup = theCell->inGroup;
+    c.hold = theCell->hold;
+  }
+  w.put(SNAP_CELLS, snap_cells);
+  vector< snap_cell >().swap(snap_cells);
+
+  vector< snap_pin > snap_pins(pins.size());
+  for(int i = 0; i < pins.size(); i++) {
+    pin* thePin = &pins[i];
+    snap_pin& p = snap_pins[i];
+    memset(&p, 0, sizeof(p));
+    p.x_coord = thePin->x_coord;
+    p.y_coord = thePin->y_coord;
+    p.x_offset = thePin->x_offset;
+    p.y_offset = thePin->y_offset;
+    p.owner = thePin->owner;
+    p.mpin = thePin->mpin;
+    p.net = thePin->net;
+    p.type = thePin->type;
+    p.isFlopInput = thePin->isFlopInput;
+    p.isFlopCkPort = thePin->isFlopCkPort;
+    p.isFixed = thePin->isFixed;
+  }
+  for(auto& it : pin2id) {
+    snap_pins[it.second].name = w.str(it.first);
+  }
+  w.put(SNAP_PINS, snap_pins);
+  vector< snap_pin >().swap(snap_pins);
+
+  vector< snap_net > snap_nets(nets.size());
+  for(int i = 0; i < nets.size(); i++) {
+    net* theNet = &nets[i];
+    snap_net& n = snap_nets[i];
+    memset(&n, 0, sizeof(n));
+    n.name = w.str(theNet->name);
+    n.source = theNet->source;
+    n.sinks = w.uint_list(theNet->sinks.data(), theNet->sinks.size());
+  }
+  w.put(SNAP_NETS, snap_nets);
+  vector< snap_net >().swap(snap_nets);
+
+  for(int k = 0; k < 2; k++) {
+    vector< row >& list = (k == 0) ? rows : prevrows;
+    vector< snap_row > snap_rows(list.size());
+    for(int i = 0; i < list.size(); i++) {
+      snap_row& r = snap_rows[i];
+      r.name = w.str(list[i].name);
+      r.site = list[i].site;
+      r.origX = list[i].origX;
+      r.origY = list[i].origY;
+      r.stepX = list[i].stepX;
+      r.stepY = list[i].stepY;
+      r.numSites = list[i].numSites;
+      r.siteorient = list[i].siteorient;
+      r.top_power = list[i].top_power;
+    }
+    w.put((k == 0) ? SNAP_ROWS : SNAP_PREVROWS, snap_rows);
+  }
+
+  vector< snap_group > snap_groups(groups.size());
+  for(int i = 0; i < groups.size(); i++) {
+    group* theGroup = &groups[i];
+    snap_group& g = snap_groups[i];
+    g.name = w.str(theGroup->name);
+    g.type = w.str(theGroup->type);
+    g.tag = w.str(theGroup->tag);
+    g.boundary = theGroup->boundary;
+    g.util = theGroup->util;
+    g.regions = w.rect_list(theGroup->regions);
+    vector< unsigned > siblings(theGroup->siblings.size());
+    for(int j = 0; j < siblings.size(); j++) {
+      siblings[j] = theGroup->siblings[j]->id;
+    }
+    g.siblings = w.uint_list(siblings.data(), siblings.size());
+  }
+  w.put(SNAP_GROUPS, snap_groups);
+
+  vector< snap_edge_spacing > spacing;
+  for(auto& it : edge_spacing) {
+    snap_edge_spacing e = {it.first.first, it.first.second, it.second};
+    spacing.push_back(e);
+  }
+  w.put(SNAP_EDGE_SPACING, spacing);
+
+  vector< snap_def_component > comps(def_components.size());
+  for(int i = 0; i < def_components.size(); i++) {
+    comps[i].text = def_components[i].text;
+    comps[i].cell = def_components[i].cell;
+    comps[i].status = def_components[i].status;
+    comps[i].nets_len = def_components[i].nets_len;
+    comps[i].extra_len = def_components[i].extra_len;
+  }
+  w.put(SNAP_DEF_COMPONENTS, comps);
+  w.put(SNAP_DEF_TEXT, def_component_text.data(), def_component_text.size(),
+        1);
+
+  w.put(SNAP_GRID_CELL, grid.linked_cell);
+  w.put(SNAP_GRID_GROUP, grid.group);
+  vector< uint8_t > valid(grid.isValid.begin(), grid.isValid.end());
+  w.put(SNAP_GRID_VALID, valid);
+
+  if(!w.write(file)) return false;
+  std::cout << " snapshot saved : " << file << endl;
+  return true;
+}
+
+// Restores a circuit saved by save_snapshot into an empty circuit. Name
+// lookup maps of cells / nets are left empty, as only the parsers use them;
+// pin2id is kept since PI/PO names live only there. Bitmaps, gaps and
+// objective stats are rebuilt from the grid.
+bool circuit::load_snapshot(const string& file) {
+  if(!cells.empty() || !macros.empty()) {
+    cerr << "load_snapshot:: design already loaded. " << endl;
+    return false;
+  }
+  snap_reader r;
+  if(!r.open(file)) return false;
+
+  size_t n_sc, n_uint, n_rect, n_cell, n_pin, n_net;
+  size_t n_row, n_prow, n_group, n_edge, n_comp, n_text;
+  size_t n_gcell, n_ggroup, n_gvalid;
+  const snap_scalars* sc = r.get< snap_scalars >(SNAP_SCALARS, &n_sc);
+  const unsigned* uints = r.get< unsigned >(SNAP_UINTS, &n_uint);
+  const rect* rects = r.get< rect >(SNAP_RECTS, &n_rect);
+  const snap_cell* scell = r.get< snap_cell >(SNAP_CELLS, &n_cell);
+  const snap_pin* spin = r.get< snap_pin >(SNAP_PINS, &n_pin);
+  const snap_net* snet = r.get< snap_net >(SNAP_NETS, &n_net);
+  const snap_row* srow = r.get< snap_row >(SNAP_ROWS, &n_row);
+  const snap_row* sprow = r.get< snap_row >(SNAP_PREVROWS, &n_prow);
+  const snap_group* sgroup = r.get< snap_group >(SNAP_GROUPS, &n_group);
+  const snap_edge_spacing* sedge =
+      r.get< snap_edge_spacing >(SNAP_EDGE_SPACING, &n_edge);
+  const snap_def_component* scomp =
+      r.get< snap_def_component >(SNAP_DEF_COMPONENTS, &n_comp);
+  const char* text = r.get< char >(SNAP_DEF_TEXT, &n_text);
+  const unsigned* gcell = r.get< unsigned >(SNAP_GRID_CELL, &n_gcell);
+  const unsigned short* ggroup =
+      r.get< unsigned short >(SNAP_GRID_GROUP, &n_ggroup);
+  const uint8_t* gvalid = r.get< uint8_t >(SNAP_GRID_VALID, &n_gvalid);
+  if(!sc || n_sc != 1 || !uints || !rects || !scell || !spin || !snet ||
+     !srow || !sprow || !sgroup || !sedge || !scomp || !text || !gcell ||
+     !ggroup || !gvalid) {
+    cerr << "load_snapshot:: '" << file << "' record layout mismatch. "
+         << endl;
+    return false;
+  }
+  size_t sites = (size_t)sc->grid_rows * sc->grid_cols;
+  if(n_gcell != sites || n_ggroup != sites || n_gvalid != sites) {
+    cerr << "load_snapshot:: '" << file << "' grid size mismatch. " << endl;
+    return false;
+  }
+
+  design_util = sc->design_util;
+  total_mArea = sc->total_mArea;
+  total_fArea = sc->total_fArea;
+  designArea = sc->designArea;
+  rowHeight = sc->rowHeight;
+  lx = sc->lx;
+  rx = sc->rx;
+  by = sc->by;
+  ty = sc->ty;
+  minVddCoordiY = sc->minVddCoordiY;
+  max_utilization = sc->max_utilization;
+  displacement = sc->displacement;
+  max_disp_const = sc->max_disp_const;
+  LEFManufacturingGrid = sc->LEFManufacturingGrid;
+  die = sc->die;
+  core = sc->core;
+  def_comps_begin = sc->def_comps_begin;
+  def_comps_end = sc->def_comps_end;
+  wsite = sc->wsite;
+  max_cell_height = sc->max_cell_height;
+  initial_power = static_cast< opendp::power >(sc->initial_power);
+  GROUP_IGNORE = sc->GROUP_IGNORE;
+  num_fixed_nodes = sc->num_fixed_nodes;
+  DEFdist2Microns = sc->DEFdist2Microns;
+  in_def_name = r.str(sc->in_def_name);
+  out_def_name = r.str(sc->out_def_name);
+  benchmark = r.str(sc->benchmark);
+  design_name = r.str(sc->design_name);
+  DEFVersion = r.str(sc->DEFVersion);
+  DEFDelimiter = r.str(sc->DEFDelimiter);
+  DEFBusCharacters = r.str(sc->DEFBusCharacters);
+  LEFVersion = r.str(sc->LEFVersion);
+  LEFNamesCaseSensitive = r.str(sc->LEFNamesCaseSensitive);
+  LEFDelimiter = r.str(sc->LEFDelimiter);
+  LEFBusCharacters = r.str(sc->LEFBusCharacters);
+
+  if(!snap_get_macros(r, this, file, "load_snapshot")) return false;
+
+  cells.resize(n_cell);
+  cell_infos.resize(n_cell);
+  for(int i = 0; i < n_cell; i++) {
+    const snap_cell& c = scell[i];
+    cell* theCell = &cells[i];
+    cell_info* theInfo = &cell_infos[i];
+    theInfo->name = r.name(c.name, names);
+    theCell->id = i;
+    theCell->width = c.width;
+    theCell->height = c.height;
+    theInfo->dense_factor = c.dense_factor;
+    theCell->disp = c.disp;
+    theCell->x_coord = c.x_coord;
+    theCell->y_coord = c.y_coord;
+    theCell->init_x_coord = c.init_x_coord;
+    theCell->init_y_coord = c.init_y_coord;
+    theCell->x_pos = c.x_pos;
+    theCell->y_pos = c.y_pos;
+    theCell->type = c.type;
+    theInfo->region = c.region;
+    theCell->group = c.group;
+    theCell->cellorient = static_cast< opendp::orient >(c.cellorient);
+    theCell->isFixed = c.isFixed;
+    theCell->isPlaced = c.isPlaced;
+    theCell->inGroup = c.inGroup;
+    theCell->hold = c.hold;
+  }
+
+  pins.resize(n_pin);
+  for(int i = 0; i < n_pin; i++) {
+    const snap_pin& p = spin[i];
+    pin* thePin = &pins[i];
+    if(p.name.len > 0) pin2id[r.str(p.name)] = i;
+    thePin->id = i;
+    thePin->x_coord = p.x_coord;
+    thePin->y_coord = p.y_coord;
+    thePin->x_offset = p.x_offset;
+    thePin->y_offset = p.y_offset;
+    thePin->owner = p.owner;
+    thePin->mpin = p.mpin;
+    thePin->net = p.net;
+    thePin->type = p.type;
+    thePin->isFlopInput = p.isFlopInput;
+    thePin->isFlopCkPort = p.isFlopCkPort;
+    thePin->isFixed = p.isFixed;
+  }
+
+  nets.resize(n_net);
+  for(int i = 0; i < n_net; i++) {
+    const snap_net& n = snet[i];
+    if(!snap_in_pool(n.sinks, n_uint)) return snap_corrupt(file);
+    nets[i].name = r.name(n.name, names);
+    nets[i].source = n.source;
+    nets[i].sinks.assign(uints + n.sinks.begin,
+                         uints + n.sinks.begin + n.sinks.count);
+  }
+
+  for(int k = 0; k < 2; k++) {
+    vector< row >& list = (k == 0) ? rows : prevrows;
+    const snap_row* src = (k == 0) ? srow : sprow;
+    list.resize((k == 0) ? n_row : n_prow);
+    for(int i = 0; i < list.size(); i++) {
+      list[i].name = r.str(src[i].name);
+      list[i].site = src[i].site;
+      list[i].origX = src[i].origX;
+      list[i].origY = src[i].origY;
+      list[i].stepX = src[i].stepX;
+      list[i].stepY = src[i].stepY;
+      list[i].numSites = src[i].numSites;
+      list[i].siteorient = static_cast< opendp::orient >(src[i].siteorient);
+      list[i].top_power = static_cast< opendp::power >(src[i].top_power);
+    }
+  }
+
+  groups.resize(n_group);
+  for(int i = 0; i < n_group; i++) {
+    const snap_group& g = sgroup[i];
+    group* theGroup = &groups[i];
+    if(!snap_in_pool(g.regions, n_rect) || !snap_in_pool(g.siblings, n_uint))
+      return snap_corrupt(file);
+    theGroup->name = r.str(g.name);
+    theGroup->type = r.str(g.type);
+    theGroup->tag = r.str(g.tag);
+    theGroup->boundary = g.boundary;
+    theGroup->util = g.util;
+    theGroup->regions.assign(rects + g.regions.begin,
+                             rects + g.regions.begin + g.regions.count);
+    theGroup->siblings.resize(g.siblings.count);
+    for(int j = 0; j < g.siblings.count; j++) {
+      unsigned cellId = uints[g.siblings.begin + j];
+      if(cellId >= n_cell) return snap_corrupt(file);
+      theGroup->siblings[j] = &cells[cellId];
+    }
+    group2id[theGroup->name] = i;
+  }
+
+  for(int i = 0; i < n_edge; i++) {
+    edge_spacing[make_pair(sedge[i].left, sedge[i].right)] = sedge[i].spacing;
+  }
+
+  def_components.resize(n_comp);
+  for(int i = 0; i < n_comp; i++) {
+    if(scomp[i].cell >= n_cell ||
+       scomp[i].text + scomp[i].nets_len + scomp[i].extra_len > n_text)
+      return snap_corrupt(file);
+    def_components[i].text = scomp[i].text;
+    def_components[i].cell = scomp[i].cell;
+    def_components[i].status =
+        static_cast< opendp::def_status >(scomp[i].status);
+    def_components[i].nets_len = scomp[i].nets_len;
+    def_components[i].extra_len = scomp[i].extra_len;
+  }
+  def_component_text.assign(text, n_text);
+
+  grid.init(sc->grid_rows, sc->grid_cols);
+  memcpy(grid.linked_cell.data(), gcell, sites * sizeof(unsigned));
+  memcpy(grid.group.data(), ggroup, sites * sizeof(unsigned short));
+  for(size_t i = 0; i < sites; i++) grid.isValid[i] = gvalid[i];
+
+  dummy_cell.isFixed = true;
+  dummy_cell.isPlaced = true;
+
+  grid.build_bitmaps();
+  init_large_cell_stor();
+  init_stats();
+
+  std::cout << " snapshot loaded : " << file << endl;
+  return true;
+}
+
+// Entry for lefStor under lef_cache_dir, named after a 64 bit FNV-1a hash
+// of the image version and each file's bytes and length. Empty if a file
+// cannot be read, in which case ReadLef just parses.
+string circuit::lef_cache_file(const vector< string >& lefStor) {
+  uint64_t hash = 14695981039346656037ull;
+  auto mix = [&hash](const void* data, size_t len) {
+    const unsigned char* p = (const unsigned char*)data;
+    for(size_t i = 0; i < len; i++) {
+      hash = (hash ^ p[i]) * 1099511628211ull;
+    }
+  };
+  uint32_t version = SNAPSHOT_VERSION;
+  mix(&version, sizeof(version));
+
+  vector< char > buf(1 << 20);
+  for(auto& lef : lefStor) {
+    FILE* f = fopen(lef.c_str(), "rb");
+    if(!f) return "";
+    uint64_t len = 0;
+    size_t nb;
+    while((nb = fread(buf.data(), 1, buf.size(), f)) > 0) {
+      mix(buf.data(), nb);
+      len += nb;
+    }
+    fclose(f);
+    mix(&len, sizeof(len));
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.lefcache", (unsigned long long)hash);
+  return lef_cache_dir + "/" + name;
+}
+
+bool circuit::save_lef_cache(const string& file) {
+  snap_writer w("save_lef_cache", LEF_CACHE_MAGIC);
+  snap_put_macros(w, macros);
+
+  vector< snap_site > snap_sites(sites.size());
+  for(int i = 0; i < sites.size(); i++) {
+    string symmetries;
+    for(auto& it : sites[i].symmetries) {
+      if(!symmetries.empty()) symmetries += ' ';
+      symmetries += it;
+    }
+    snap_sites[i].name = w.str(sites[i].name);
+    snap_sites[i].type = w.str(sites[i].type);
+    snap_sites[i].symmetries = w.str(symmetries);
+    snap_sites[i].width = sites[i].width;
+    snap_sites[i].height = sites[i].height;
+  }
+  w.put(SNAP_SITES, snap_sites);
+
+  vector< snap_layer > snap_layers(layers.size());
+  for(int i = 0; i < layers.size(); i++) {
+    layer* theLayer = &layers[i];
+    snap_layer& l = snap_layers[i];
+    l.name = w.str(theLayer->name);
+    l.type = w.str(theLayer->type);
+    l.direction = w.str(theLayer->direction);
+    l.xPitch = theLayer->xPitch;
+    l.yPitch = theLayer->yPitch;
+    l.xOffset = theLayer->xOffset;
+    l.yOffset = theLayer->yOffset;
+    l.width = theLayer->width;
+    l.maxWidth = theLayer->maxWidth;
+  }
+  w.put(SNAP_LAYERS, snap_layers);
+
+  // written aside and renamed, so other runs never see a partial entry
+  string tmp = file + "." + std::to_string(getpid());
+  if(!w.write(tmp)) {
+    remove(tmp.c_str());
+    return false;
+  }
+  if(rename(tmp.c_str(), file.c_str()) != 0) {
+    cerr << "save_lef_cache:: cannot rename '" << tmp << "' to '" << file
+         << "'. " << endl;
+    remove(tmp.c_str());
+    return false;
+  }
+  std::cout << " LEF cache saved : " << file << endl;
+  return true;
+}
+
+// Fills the macro, site and layer tables from a LEF cache entry; false,
+// with the tables left empty, if there is no usable entry.
+bool circuit::load_lef_cache(const string& file) {
+  struct stat st;
+  if(stat(file.c_str(), &st) != 0) return false; /* not cached yet */
+  if(!macros.empty() || !sites.empty() || !layers.empty()) {
+    cerr << "load_lef_cache:: LEF already loaded. " << endl;
+    return false;
+  }
+  snap_reader r("load_lef_cache", LEF_CACHE_MAGIC, "a LEF cache");
+  if(!r.open(file)) return false;
+
+  size_t n_site, n_layer;
+  const snap_site* ssite = r.get< snap_site >(SNAP_SITES, &n_site);
+  const snap_layer* slayer = r.get< snap_layer >(SNAP_LAYERS, &n_layer);
+  if(!ssite || !slayer) {
+    cerr << "load_lef_cache:: '" << file << "' record layout mismatch. "
+         << endl;
+    return false;
+  }
+  if(!snap_get_macros(r, this, file, "load_lef_cache")) {
+    macros.clear();
+    macro2id.clear();
+    return false;
+  }
+
+  sites.resize(n_site);
+  for(int i = 0; i < n_site; i++) {
+    site* theSite = &sites[i];
+    theSite->name = r.str(ssite[i].name);
+    theSite->type = r.str(ssite[i].type);
+    theSite->width = ssite[i].width;
+    theSite->height = ssite[i].height;
+    string symmetries = r.str(ssite[i].symmetries);
+    size_t begin = 0;
+    while(begin < symmetries.size()) {
+      size_t end = symmetries.find(' ', begin);
+      if(end == string::npos) end = symmetries.size();
+      theSite->symmetries.push_back(symmetries.substr(begin, end - begin));
+      begin = end + 1;
+    }
+    site2id[theSite->name] = i;
+  }
+
+  layers.resize(n_layer);
+  for(int i = 0; i < n_layer; i++) {
+    const snap_layer& l = slayer[i];
+    layer* theLayer = &layers[i];
+    theLayer->name = r.str(l.name);
+    theLayer->type = r.str(l.type);
+    theLayer->direction = r.str(l.direction);
+    theLayer->xPitch = l.xPitch;
+    theLayer->yPitch = l.yPitch;
+    theLayer->xOffset = l.xOffset;
+    theLayer->yOffset = l.yOffset;
+    theLayer->width = l.width;
+    theLayer->maxWidth = l.maxWidth;
+    layer2id[theLayer->name] = i;
+  }
+
+  std::cout << "Reading LEF cache " << file << " is Done" << endl;
+  return true;
+}
@@ -79,25 +79,9 @@ void circuit::power_mapping() {
 }
 
 void circuit::evaluation() {
-  avg_displacement = 0;
-  sum_displacement = 0;
-  max_displacement = 0;
-  int count_displacement = 0;
-
-  cell* maxCell = NULL;
-
-  for(int i = 0; i < cells.size(); i++) {
-    cell* theCell = &cells[i];
-    double displacement = abs(theCell->init_x_coord - theCell->x_coord) +
-                          abs(theCell->init_y_coord - theCell->y_coord);
-    sum_displacement += displacement;
-    if(displacement > max_displacement) {
-      max_displacement = displacement;
-      maxCell = theCell;
-    }
-    count_displacement++;
-  }
-  avg_displacement = sum_displacement / count_displacement;
+  sum_displacement = current_sum_disp();
+  max_displacement = current_max_disp();
+  avg_displacement = sum_displacement / cells.size();
 
   double max_util = 0.0;
   for(int i = 0; i < groups.size(); i++) {
@@ -110,12 +94,12 @@ void circuit::evaluation() {
   cout << " SUM_displacement : " << sum_displacement << endl;
   cout << " MAX_displacement : " << max_displacement << endl;
   cout << " - - - - - - - - - - - - - - - - " << endl;
-  cout << " GP HPWL          : " << HPWL("INIT") << endl;
-  cout << " HPWL             : " << HPWL("") << endl;
+  cout << " GP HPWL          : " << initial_hpwl() << endl;
+  cout << " HPWL             : " << current_hpwl() << endl;
   cout << " avg_Disp_site    : " << Disp() / cells.size() / wsite << endl;
   cout << " avg_Disp_row     : " << Disp() / cells.size() / rowHeight << endl;
   cout << " delta_HPWL       : "
-       << (HPWL("") - HPWL("INIT")) / HPWL("INIT") * 100 << endl;
+       << (current_hpwl() - initial_hpwl()) / initial_hpwl() * 100 << endl;
 
   return;
 }
@@ -131,21 +115,44 @@ double circuit::Disp() {
   return result;
 }
 
-double circuit::HPWL(string mode) {
+double circuit::HPWL(coord_mode mode) {
   double hpwl = 0;
+  for(int i = 0; i < nets.size(); i++) {
+    hpwl += net_hpwl(&nets[i], mode);
+  }
+  return hpwl / static_cast< double >(DEFdist2Microns);
+}
 
+// half perimeter of one net's pin bounding box ( DBU )
+double circuit::net_hpwl(net* theNet, coord_mode mode) {
+  rect box;
   double x_coord = 0;
   double y_coord = 0;
 
-  for(int i = 0; i < nets.size(); i++) {
-    rect box;
-    net* theNet = &nets[i];
-    // cout << " net name : " << theNet->name << endl;
-    pin* source = &pins[theNet->source];
-
-    if(source->type == NONPIO_PIN) {
-      cell* theCell = &cells[source->owner];
-      if(mode == "INIT") {
+  pin* source = &pins[theNet->source];
+  if(source->type == NONPIO_PIN) {
+    cell* theCell = &cells[source->owner];
+    if(mode == MODE_INIT_COORD) {
+      x_coord = theCell->init_x_coord;
+      y_coord = theCell->init_y_coord;
+    }
+    else {
+      x_coord = theCell->x_coord;
+      y_coord = theCell->y_coord;
+    }
+    box.xLL = box.xUR = x_coord + source->x_offset * DEFdist2Microns;
+    box.yLL = box.yUR = y_coord + source->y_offset * DEFdist2Microns;
+  }
+  else {
+    box.xLL = box.xUR = source->x_coord;
+    box.yLL = box.yUR = source->y_coord;
+  }
+
+  for(int j = 0; j < theNet->sinks.size(); j++) {
+    pin* sink = &pins[theNet->sinks[j]];
+    if(sink->type == NONPIO_PIN) {
+      cell* theCell = &cells[sink->owner];
+      if(mode == MODE_INIT_COORD) {
         x_coord = theCell->init_x_coord;
         y_coord = theCell->init_y_coord;
       }
@@ -153,46 +160,137 @@ double circuit::HPWL(string mode) {
         x_coord = theCell->x_coord;
         y_coord = theCell->y_coord;
       }
-      box.xLL = box.xUR = x_coord + source->x_offset * DEFdist2Microns;
-      box.yLL = box.yUR = y_coord + source->y_offset * DEFdist2Microns;
+      box.xLL = min(box.xLL, x_coord + sink->x_offset * DEFdist2Microns);
+      box.xUR = max(box.xUR, x_coord + sink->x_offset * DEFdist2Microns);
+      box.yLL = min(box.yLL, y_coord + sink->y_offset * DEFdist2Microns);
+      box.yUR = max(box.yUR, y_coord + sink->y_offset * DEFdist2Microns);
     }
     else {
-      box.xLL = box.xUR = source->x_coord;
-      box.yLL = box.yUR = source->y_coord;
+      box.xLL = min(box.xLL, sink->x_coord);
+      box.xUR = max(box.xUR, sink->x_coord);
+      box.yLL = min(box.yLL, sink->y_coord);
+      box.yUR = max(box.yUR, sink->y_coord);
     }
-      
-    for(int j = 0; j < theNet->sinks.size(); j++) {
-      pin* sink = &pins[theNet->sinks[j]];
-      // cout << " sink name : " << sink->name << endl;
-      if(sink->type == NONPIO_PIN) {
-        cell* theCell = &cells[sink->owner];
-        if(mode == "INIT") {
-          x_coord = theCell->init_x_coord;
-          y_coord = theCell->init_y_coord;
-        }
-        else {
-          x_coord = theCell->x_coord;
-          y_coord = theCell->y_coord;
-        }
-        box.xLL = min(box.xLL, x_coord + sink->x_offset * DEFdist2Microns);
-        box.xUR = max(box.xUR, x_coord + sink->x_offset * DEFdist2Microns);
-        box.yLL = min(box.yLL, y_coord + sink->y_offset * DEFdist2Microns);
-        box.yUR = max(box.yUR, y_coord + sink->y_offset * DEFdist2Microns);
-      }
-      else {
-        box.xLL = min(box.xLL, sink->x_coord);
-        box.xUR = max(box.xUR, sink->x_coord);
-        box.yLL = min(box.yLL, sink->y_coord);
-        box.yUR = max(box.yUR, sink->y_coord);
-      }
+  }
+  return (box.xUR - box.xLL + box.yUR - box.yLL);
+}
+
+// seeds the running stats from the parsed placement
+void circuit::init_stats() {
+  disp_sum = 0;
+  disp_heap = std::priority_queue< pair< int, unsigned > >();
+  for(int i = 0; i < cells.size(); i++) {
+    cell* theCell = &cells[i];
+    theCell->disp = abs(theCell->init_x_coord - theCell->x_coord) +
+                    abs(theCell->init_y_coord - theCell->y_coord);
+    disp_sum += (long long)theCell->disp;
+    disp_heap.push(make_pair(theCell->disp, (unsigned)i));
+  }
+  init_net_stats();
+  return;
+}
+
+// net side of init_stats; nets read by load_nets start here too
+void circuit::init_net_stats() {
+  // nets touched by each cell, duplicates removed
+  vector< pair< unsigned, unsigned > > cell_net;
+  cell_net.reserve(pins.size());
+  for(int i = 0; i < pins.size(); i++) {
+    pin* thePin = &pins[i];
+    if(thePin->type != NONPIO_PIN || thePin->owner == UINT_MAX ||
+       thePin->net == UINT_MAX)
+      continue;
+    cell_net.push_back(make_pair(thePin->owner, thePin->net));
+  }
+  sort(cell_net.begin(), cell_net.end());
+  cell_net.erase(unique(cell_net.begin(), cell_net.end()), cell_net.end());
+  cell_net_start.assign(cells.size() + 1, 0);
+  cell_nets.resize(cell_net.size());
+  for(int i = 0; i < cell_net.size(); i++) {
+    cell_net_start[cell_net[i].first + 1]++;
+    cell_nets[i] = cell_net[i].second;
+  }
+  for(int i = 0; i < cells.size(); i++) {
+    cell_net_start[i + 1] += cell_net_start[i];
+  }
+
+  init_hpwl = HPWL(MODE_INIT_COORD);
+  net_box.resize(nets.size());
+  net_dirty.assign(nets.size(), 0);
+  hpwl_dirty = 0;
+  hpwl_sum = 0;
+  for(int i = 0; i < nets.size(); i++) {
+    net_box[i] = net_hpwl(&nets[i], MODE_COORD);
+    hpwl_sum += net_box[i];
+  }
+  return;
+}
+
+// call after theCell's coordinates changed; safe inside parallel placement
+void circuit::track_move(cell* theCell) {
+  int new_disp = abs(theCell->init_x_coord - theCell->x_coord) +
+                 abs(theCell->init_y_coord - theCell->y_coord);
+  if(new_disp != theCell->disp) {
+    __atomic_fetch_add(&disp_sum, (long long)new_disp - (long long)theCell->disp,
+                       __ATOMIC_RELAXED);
+    theCell->disp = new_disp;
+#pragma omp critical(disp_heap)
+    disp_heap.push(make_pair(new_disp, theCell->id));
+  }
+
+  if(cell_net_start.empty()) return;
+  for(unsigned i = cell_net_start[theCell->id];
+      i < cell_net_start[theCell->id + 1]; i++) {
+    __atomic_store_n(&net_dirty[cell_nets[i]], 1, __ATOMIC_RELAXED);
+  }
+  if(cell_net_start[theCell->id] != cell_net_start[theCell->id + 1])
+    __atomic_store_n(&hpwl_dirty, 1, __ATOMIC_RELAXED);
+  return;
+}
+
+double circuit::current_sum_disp() { return (double)disp_sum; }
+
+double circuit::current_max_disp() {
+  // drop entries left behind by later moves; rebuild once mostly stale
+  if(disp_heap.size() > 2 * cells.size() + 64) {
+    disp_heap = std::priority_queue< pair< int, unsigned > >();
+    for(int i = 0; i < cells.size(); i++) {
+      disp_heap.push(make_pair(cells[i].disp, (unsigned)i));
     }
-    
+  }
+  while(!disp_heap.empty() &&
+        disp_heap.top().first != cells[disp_heap.top().second].disp) {
+    disp_heap.pop();
+  }
+  return disp_heap.empty() ? 0.0 : disp_heap.top().first;
+}
 
-    double box_boundary = (box.xUR - box.xLL + box.yUR - box.yLL);
+// reads the NETS statement skipped by lazy_nets
+void circuit::load_nets() {
+  if(!nets_deferred) return;
+  ReadDefNets();
+  init_net_stats();
+  return;
+}
 
-    hpwl += box_boundary;
+double circuit::initial_hpwl() {
+  load_nets();
+  return init_hpwl;
+}
+
+double circuit::current_hpwl() {
+  load_nets();
+  if(hpwl_dirty) {
+    for(int i = 0; i < nets.size(); i++) {
+      if(net_dirty[i] == 0) continue;
+      double box = net_hpwl(&nets[i], MODE_COORD);
+      hpwl_sum += box - net_box[i];
+      net_box[i] = box;
+      net_dirty[i] = 0;
+    }
+    hpwl_dirty = 0;
   }
-  return hpwl / static_cast< double >(DEFdist2Microns);
+  return hpwl_sum / static_cast< double >(DEFdist2Microns);
 }
 
 double circuit::calc_density_factor(double unit) {
@@ -259,6 +357,7 @@ double circuit::calc_density_factor(double unit) {
   }
 
   /* (b) add utilization by fixed/movable objects */
+  vector< unsigned > cell_bin(cells.size(), UINT_MAX); /* bin of the center */
   for(vector< cell >::iterator theCell = cells.begin(); theCell != cells.end();
       ++theCell) {
     int lcol = max((int)floor((theCell->init_x_coord - lx) / gridUnit), 0);
@@ -276,7 +375,7 @@ double circuit::calc_density_factor(double unit) {
 
         if(theCell->inGroup)
           bins[binId].density_limit = max(
-              bins[binId].density_limit, groups[group2id[theCell->group]].util);
+              bins[binId].density_limit, groups[theCell->group].util);
 
         /* get intersection */
         double lx = max(bins[binId].lx, (double)theCell->init_x_coord);
@@ -292,7 +391,7 @@ double circuit::calc_density_factor(double unit) {
 
         if(bins[binId].lx <= x_center && x_center < bins[binId].hx)
           if(bins[binId].ly < y_center && y_center < bins[binId].hy)
-            theCell->binId = binId;
+            cell_bin[theCell->id] = binId;
 
         if((hx - lx) > 1.0e-5 && (hy - ly) > 1.0e-5) {
           double common_area = (hx - lx) * (hy - ly);
@@ -305,13 +404,11 @@ double circuit::calc_density_factor(double unit) {
     }
   }
 
-  for(vector< cell >::iterator theCell = cells.begin(); theCell != cells.end();
-      ++theCell) {
-    if(theCell->binId == UINT_MAX) continue;
-    density_bin* theBin = &bins[theCell->binId];
-    theCell->dense_factor +=
+  for(unsigned i = 0; i < cells.size(); i++) {
+    if(cell_bin[i] == UINT_MAX) continue;
+    density_bin* theBin = &bins[cell_bin[i]];
+    cell_infos[i].dense_factor +=
         theBin->m_util / (theBin->free_space - theBin->f_util);
-    theCell->binId = UINT_MAX;
   }
 
   return 0.0;
@@ -352,20 +449,20 @@ void circuit::group_analyze() {
 
 pair< int, int > circuit::nearest_coord_to_rect_boundary(cell* theCell,
                                                          rect* theRect,
-                                                         string mode) {
+                                                         coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
   int size_x = (int)floor(theCell->width / wsite + 0.5);
   int size_y = (int)floor(theCell->height / rowHeight + 0.5);
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -376,7 +473,7 @@ pair< int, int > circuit::nearest_coord_to_rect_boundary(cell* theCell,
   int temp_x = x;
   int temp_y = y;
 
-  if(check_overlap(theCell, theRect, "init_coord") == true) {
+  if(check_overlap(theCell, theRect, MODE_INIT_COORD) == true) {
     int dist_x = 0;
     int dist_y = 0;
     if(abs(x - theRect->xLL + theCell->width) > abs(theRect->xUR - x)) {
@@ -424,18 +521,18 @@ pair< int, int > circuit::nearest_coord_to_rect_boundary(cell* theCell,
   return make_pair(temp_x, temp_y);
 }
 
-int circuit::dist_for_rect(cell* theCell, rect* theRect, string mode) {
+int circuit::dist_for_rect(cell* theCell, rect* theRect, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -468,18 +565,18 @@ bool circuit::check_overlap(rect cell, rect box) {
   return true;
 }
 
-bool circuit::check_overlap(cell* theCell, rect* theRect, string mode) {
+bool circuit::check_overlap(cell* theCell, rect* theRect, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -500,18 +597,18 @@ bool circuit::check_inside(rect cell, rect box) {
   return true;
 }
 
-bool circuit::check_inside(cell* theCell, rect* theRect, string mode) {
+bool circuit::check_inside(cell* theCell, rect* theRect, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -551,96 +648,75 @@ pair< bool, pair< int, int > > circuit::bin_search(int x_pos, cell* theCell,
 #ifdef DEBUG
   cout << " - - - - - - - - - - - - - - - - - " << endl;
   cout << " Start Bin Search " << endl;
-  cout << " cell name : " << theCell->name << endl;
+  cout << " cell name : " << cell_name(theCell) << endl;
   cout << " target x : " << x << endl;
   cout << " target y : " << y << endl;
 #endif
 
-  if(x_pos > x) {
-    for(int i = 9; i > -1; i--) {
-      // check all grids are empty
-      bool available = true;
-
-      if(x + i + x_step > (int)(die.xUR / wsite)) {
-        available = false;
-      }
-      else {
-        for(int k = y; k < y + y_step; k++) {
-          for(int l = x + i; l < x + i + x_step; l++) {
-            if(grid[k][l].linked_cell != NULL || grid[k][l].isValid == false) {
-              available = false;
-              break;
-            }
-            // check group regions
-            if(theCell->inGroup == true) {
-              if(grid[k][l].group != group2id[theCell->group])
-                available = false;
-            }
-            else {
-              if(grid[k][l].group != UINT_MAX) available = false;
-            }
-          }
-          if(available == false) break;
-        }
-      }
-      if(available == true) {
-        if(edge_left == 0)
-          pos = make_pair(y, x + i);
-        else
-          pos = make_pair(y, x + i + edge_left);
-
-        return make_pair(available, pos);
-      }
+  unsigned groupId =
+      (theCell->inGroup == true) ? theCell->group : UINT_MAX;
+  int x_limit = (int)(die.xUR / wsite);
+
+  // check 10 candidates ( x ~ x + 9 ) from the side closer to x_pos
+  int count = min(10, x_limit - x - x_step + 1);
+  if(count <= 0) return make_pair(false, pos);
+
+  int i = -1;
+  if(count + x_step <= 65) {
+    uint64_t starts =
+        grid.free_run_starts(y, y_step, x, count, x_step, groupId);
+    if(starts != 0) {
+      if(x_pos > x)
+        i = 63 - __builtin_clzll(starts);
+      else
+        i = __builtin_ctzll(starts);
+    }
+  }
+  // wide cells : a blocked site skips every candidate whose span covers it
+  else if(x_pos > x) {
+    int cand = count - 1;
+    while(cand > -1 && i < 0) {
+      int blocked =
+          grid.prev_blocked(y, y_step, x + cand, x + cand + x_step, groupId);
+      if(blocked < 0)
+        i = cand;
+      else
+        cand = blocked - x_step - x;
     }
   }
   else {
-    for(int i = 0; i < 10; i++) {
-      // check all grids are empty
-      bool available = true;
-      if(x + i + x_step > (int)(die.xUR / wsite)) {
-        available = false;
-      }
-      else {
-        for(int k = y; k < y + y_step; k++) {
-          for(int l = x + i; l < x + i + x_step; l++) {
-            if(grid[k][l].linked_cell != NULL || grid[k][l].isValid == false) {
-              available = false;
-              break;
-            }
-            // check group regions
-            if(theCell->inGroup == true) {
-              if(grid[k][l].group != group2id[theCell->group])
-                available = false;
-            }
-            else {
-              if(grid[k][l].group != UINT_MAX) available = false;
-            }
-          }
-          if(available == false) break;
-        }
-      }
-      if(available == true) {
+    int cand = 0;
+    while(cand < count && i < 0) {
+      int blocked =
+          grid.next_blocked(y, y_step, x + cand, x + cand + x_step, groupId);
+      if(blocked < 0)
+        i = cand;
+      else
+        cand = blocked + 1 - x;
+    }
+  }
+
+  if(i > -1) {
 #ifdef DEBUG
-        cout << " found pos x - y : " << x << " - " << y << " Finish Search "
-             << endl;
-        cout << " - - - - - - - - - - - - - - - - - - - - - - - - " << endl;
+    cout << " found pos x - y : " << x << " - " << y << " Finish Search "
+         << endl;
+    cout << " - - - - - - - - - - - - - - - - - - - - - - - - " << endl;
 #endif
-        if(edge_left == 0)
-          pos = make_pair(y, x + i);
-        else
-          pos = make_pair(y, x + i + edge_left);
+    if(edge_left == 0)
+      pos = make_pair(y, x + i);
+    else
+      pos = make_pair(y, x + i + edge_left);
 
-        return make_pair(available, pos);
-      }
-    }
+    return make_pair(true, pos);
   }
   return make_pair(false, pos);
 }
 
-pair< bool, pixel* > circuit::diamond_search(cell* theCell, int x_coord,
-                                             int y_coord) {
-  pixel* myPixel = NULL;
-  pair< bool, pair< int, int > > found;
+// col_begin / col_end : only spans inside sites [col_begin, col_end)
+pair< bool, pixel > circuit::diamond_search(cell* theCell, int x_coord,
+                                            int y_coord, int col_begin,
+                                            int col_end) {
+  pixel myPixel;
   int x_pos = (int)floor(x_coord / wsite + 0.5);
   int y_pos = (int)floor(y_coord / rowHeight + 0.5);
 
@@ -651,7 +727,7 @@ pair< bool, pixel* > circuit::diamond_search(cell* theCell, int x_coord,
 
   // set search boundary max / min
   if(theCell->inGroup == true) {
-    group* theGroup = &groups[group2id[theCell->group]];
+    group* theGroup = &groups[theCell->group];
     x_start = max(x_pos - (int)(displacement * 5),
                   (int)floor(theGroup->boundary.xLL / wsite));
     x_end = min(x_pos + (int)(displacement * 5),
@@ -675,7 +751,7 @@ pair< bool, pixel* > circuit::diamond_search(cell* theCell, int x_coord,
   }
 #ifdef DEBUG
   cout << " == Start Diamond Search ==  " << endl;
-  cout << " cell_name : " << theCell->name << endl;
+  cout << " cell_name : " << cell_name(theCell) << endl;
   cout << " cell width : " << theCell->width << endl;
   cout << " cell height : " << theCell->height << endl;
   cout << " cell x step : " << (int)floor(theCell->width / wsite + 0.5) << endl;
@@ -688,86 +764,80 @@ pair< bool, pixel* > circuit::diamond_search(cell* theCell, int x_coord,
   cout << " x bound ( " << x_start << ") - (" << x_end << ")" << endl;
   cout << " y bound ( " << y_start << ") - (" << y_end << ")" << endl;
 #endif
-  found = bin_search(x_pos, theCell, min(x_end, max(x_start, x_pos)),
-                     max(y_start, min(y_end, y_pos)));
-  if(found.first == true) {
-    myPixel = &grid[found.second.first][found.second.second];
-    return make_pair(found.first, myPixel);
-  }
-
-  int div = 4;
-  if(design_util > 0.6 || num_fixed_nodes > 0) div = 1;
-
-  for(int i = 1; i < (int)(displacement * 2) / div; i++) {
-    vector< pixel* > avail_list;
-    avail_list.reserve(i * 4);
-    pixel* myPixel = NULL;
-
-    int x_offset = 0;
-    int y_offset = 0;
-
-    // right side
-    for(int j = 1; j < i * 2; j++) {
-      x_offset = -((j + 1) / 2);
-      if(j % 2 == 1)
-        y_offset = (i * 2 - j) / 2;
-      else
-        y_offset = -(i * 2 - j) / 2;
-      found = bin_search(x_pos, theCell,
-                         min(x_end, max(x_start, (x_pos + x_offset * 10))),
-                         min(y_end, max(y_start, (y_pos + y_offset))));
-      if(found.first == true) {
-        myPixel = &grid[found.second.first][found.second.second];
-        avail_list.push_back(myPixel);
-      }
-    }
-
-    // left side
-    for(int j = 1; j < (i + 1) * 2; j++) {
-      x_offset = (j - 1) / 2;
-      if(j % 2 == 1)
-        y_offset = ((i + 1) * 2 - j) / 2;
-      else
-        y_offset = -((i + 1) * 2 - j) / 2;
-      found = bin_search(x_pos, theCell,
-                         min(x_end, max(x_start, (x_pos + x_offset * 10))),
-                         min(y_end, max(y_start, (y_pos + y_offset))));
-      if(found.first == true) {
-        myPixel = &grid[found.second.first][found.second.second];
-        avail_list.push_back(myPixel);
+  macro* theMacro = &macros[theCell->type];
+  int edge_left = (theMacro->edgetypeLeft == 1) ? 2 : 0;
+  int edge_right = (theMacro->edgetypeRight == 1) ? 2 : 0;
+  int x_step = (int)ceil(theCell->width / wsite) + edge_left + edge_right;
+  int y_step = (int)ceil(theCell->height / rowHeight);
+  unsigned groupId =
+      (theCell->inGroup == true) ? theCell->group : UINT_MAX;
+
+  // x bound of the span including edge spacing
+  x_start = max(x_start, col_begin + edge_left);
+  x_end = min(x_end, min((int)(die.xUR / wsite), col_end) - x_step);
+  int y_top = (int)(die.yUR / rowHeight) - y_step;
+  int x_target = min(x_end, max(x_start, x_pos)) - edge_left;
+  int y_center = max(y_start, min(y_end, y_pos));
+
+  // visit rows outward from y_center, nearest fit per row, until the
+  // row distance alone exceeds the best displacement
+  int best_dist = INT_MAX;
+  for(int i = 0; y_center - i >= y_start || y_center + i <= y_end; i++) {
+    bool in_reach = false;
+    for(int side = 0; side < 2; side++) {
+      if(i == 0 && side == 1) break;
+      int y = (side == 0) ? y_center + i : y_center - i;
+      if(y < y_start || y > y_end || y > y_top) continue;
+
+      int y_dist = abs(y_coord - y * (int)rowHeight);
+      if(y_dist >= best_dist) continue;
+      in_reach = true;
+
+      // even number multi-deck cell -> check top power
+      if(y_step % 2 == 0 && rows[y].top_power == theMacro->top_power)
+        continue;
+
+      int x_min = x_start - edge_left;
+      int x_max = x_end;
+      if(best_dist != INT_MAX) {
+        int reach = (best_dist - y_dist) / (int)wsite + 1;
+        x_min = max(x_min, x_pos - edge_left - reach);
+        x_max = min(x_max, x_pos - edge_left + reach);
       }
-    }
-
-    // check from vector
-    unsigned dist = UINT_MAX;
-    int best = INT_MAX;
-    for(int j = 0; j < avail_list.size(); j++) {
-      int temp_dist = abs(x_coord - avail_list[j]->x_pos * wsite) +
-                      abs(y_coord - avail_list[j]->y_pos * rowHeight);
-      if(temp_dist < dist) {
-        dist = temp_dist;
-        best = j;
+      if(x_min < 0) x_min = 0;
+      if(x_max < x_min) continue;
+      int x_from = max(x_min, min(x_max, x_target));
+
+      int fits[2] = {
+          grid.fit_left(y, y_step, x_from, x_step, groupId, x_min),
+          grid.fit_right(y, y_step, x_from, x_step, groupId, x_max)};
+      for(int j = 0; j < 2; j++) {
+        if(fits[j] < 0) continue;
+        int x = fits[j] + edge_left;
+        int dist = abs(x_coord - x * (int)wsite) + y_dist;
+        if(dist < best_dist) {
+          best_dist = dist;
+          myPixel = pixel(x, y);
+        }
       }
     }
-    if(best != INT_MAX) {
-      return make_pair(true, avail_list[best]);
-    }
+    if(in_reach == false && i > 0 && best_dist != INT_MAX) break;
   }
-  return make_pair(false, myPixel);
+  return make_pair(best_dist != INT_MAX, myPixel);
 }
 
-bool circuit::direct_move(cell* theCell, string mode) {
+bool circuit::direct_move(cell* theCell, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -779,8 +849,6 @@ bool circuit::direct_move(cell* theCell, string mode) {
 }
 
 bool circuit::direct_move(cell* theCell, int x_coord, int y_coord) {
-  pixel* myPixel = NULL;
-  pair< bool, pair< int, int > > found;
   int x_pos = (int)floor(x_coord / wsite + 0.5);
   int y_pos = (int)floor(y_coord / rowHeight + 0.5);
 
@@ -797,7 +865,7 @@ bool circuit::direct_move(cell* theCell, int x_coord, int y_coord) {
   else {
     for(int i = y_pos; i < y_end; i++) {
       for(int j = x_pos; j < x_end; j++) {
-        if(grid[i][j].linked_cell != NULL || grid[i][j].isValid == true)
+        if(grid.cell_at(i, j) != PIXEL_EMPTY || grid.valid_at(i, j) == true)
           return false;
       }
     }
@@ -806,17 +874,57 @@ bool circuit::direct_move(cell* theCell, int x_coord, int y_coord) {
   }
 }
 
+// rip up the cells around ( x, y ), insert theCell and put them back.
+// windows of 1 - 3 cell sizes and two re-insert orders are tried on the
+// undo log; the one with the least total displacement is kept. Nothing
+// changes if every try fails
 bool circuit::shift_move(cell* theCell, int x, int y) {
-  //	cout << " shift_move start " << endl;
+  int best_window = 0;
+  bool best_large_first = false;
+  double best_disp = DBL_MAX;
+  for(int window = 1; window <= 3; window++) {
+    for(int order = 0; order < 2; order++) {
+      size_t mark = begin_moves();
+      bool success = rip_up_move(theCell, x, y, window, order == 1);
+      double disp = current_sum_disp();
+      rollback_moves(mark);
+      if(success && disp < best_disp) {
+        best_disp = disp;
+        best_window = window;
+        best_large_first = (order == 1);
+      }
+    }
+  }
 
-  // set resgion boundary
+  if(best_window == 0) {
+    cout << " can't insert center cell !! " << endl;
+    cout << " cell_name : " << cell_name(theCell) << endl;
+    return false;
+  }
+  size_t mark = begin_moves();
+  bool success = rip_up_move(theCell, x, y, best_window, best_large_first);
+  assert(success == true);
+  commit_moves(mark);
+  return success;
+}
+
+// one shift_move try : erase the same kind cells within window cell sizes,
+// place theCell, then re-insert them from their initial coordinates
+bool circuit::rip_up_move(cell* theCell, int x, int y, int window,
+                          bool large_first) {
   rect theRect;
-  theRect.xLL = max(die.xLL, x - theCell->width * 3);
-  theRect.xUR = min(die.xUR, x + theCell->width * 3);
-  theRect.yLL = max(die.yLL, y - theCell->height * 3);
-  theRect.yUR = min(die.yUR, y + theCell->height * 3);
+  theRect.xLL = max(die.xLL, x - theCell->width * window);
+  theRect.xUR = min(die.xUR, x + theCell->width * window);
+  theRect.yLL = max(die.yLL, y - theCell->height * window);
+  theRect.yUR = min(die.yUR, y + theCell->height * window);
 
   vector< cell* > overlap_region_cells = get_cells_from_boundary(&theRect);
+  if(large_first) {
+    std::stable_sort(overlap_region_cells.begin(), overlap_region_cells.end(),
+                     [](cell* a, cell* b) {
+                       return a->width * a->height > b->width * b->height;
+                     });
+  }
 
   // erase region cells
   for(int i = 0; i < overlap_region_cells.size(); i++) {
@@ -828,11 +936,7 @@ bool circuit::shift_move(cell* theCell, int x, int y) {
   }
 
   // place target cell
-  if(map_move(theCell, x, y) == false) {
-    cout << " can't insert center cell !! " << endl;
-    cout << " cell_name : " << theCell->name << endl;
-    return false;
-  }
+  if(map_move(theCell, x, y) == false) return false;
 
   // rebuild erased cells
   for(int i = 0; i < overlap_region_cells.size(); i++) {
@@ -842,7 +946,7 @@ bool circuit::shift_move(cell* theCell, int x, int y) {
                   around_cell->init_y_coord) == false) {
 #ifdef DEBUG
         cout << " Shift move fail !!" << endl;
-        cout << " cell name : " << around_cell->name << endl;
+        cout << " cell name : " << cell_name(around_cell) << endl;
         cout << " x_coord : " << around_cell->init_x_coord << endl;
         cout << " y_coord : " << around_cell->init_y_coord << endl;
 #endif
@@ -853,18 +957,52 @@ bool circuit::shift_move(cell* theCell, int x, int y) {
   return true;
 }
 
-bool circuit::shift_move(cell* theCell, string mode) {
+// move transactions : paint_pixel / erase_pixel calls between begin_moves
+// and commit_moves / rollback_moves are logged; rollback replays the log
+// backwards. Transactions nest
+size_t circuit::begin_moves() {
+  undo_depth++;
+  return undo_log.size();
+}
+
+void circuit::commit_moves(size_t mark) {
+  assert(undo_depth > 0);
+  if(--undo_depth == 0) undo_log.clear();
+  return;
+}
+
+void circuit::rollback_moves(size_t mark) {
+  assert(undo_depth > 0);
+  int depth = undo_depth;
+  undo_depth = 0;
+  for(size_t i = undo_log.size(); i > mark; i--) {
+    pixel_change* change = &undo_log[i - 1];
+    cell* theCell = &cells[change->cell];
+    if(change->painted)
+      erase_pixel(theCell);
+    else {
+      paint_pixel(theCell, change->x_pos, change->y_pos);
+      theCell->hold = change->hold;
+    }
+  }
+  undo_log.resize(mark);
+  undo_depth = depth - 1;
+  if(undo_depth == 0) undo_log.clear();
+  return;
+}
+
+bool circuit::shift_move(cell* theCell, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -875,18 +1013,18 @@ bool circuit::shift_move(cell* theCell, string mode) {
   return shift_move(theCell, x, y);
 }
 
-bool circuit::map_move(cell* theCell, string mode) {
+bool circuit::map_move(cell* theCell, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -898,23 +1036,23 @@ bool circuit::map_move(cell* theCell, string mode) {
 }
 
 bool circuit::map_move(cell* theCell, int x, int y) {
-  pair< bool, pixel* > myPixel = diamond_search(theCell, x, y);
+  pair< bool, pixel > myPixel = diamond_search(theCell, x, y);
   if(myPixel.first == true) {
-    pair< bool, pixel* > nearPixel =
-        diamond_search(theCell, myPixel.second->x_pos * wsite,
-                       myPixel.second->y_pos * rowHeight);
+    pair< bool, pixel > nearPixel =
+        diamond_search(theCell, myPixel.second.x_pos * wsite,
+                       myPixel.second.y_pos * rowHeight);
     if(nearPixel.first == true) {
-      paint_pixel(theCell, nearPixel.second->x_pos, nearPixel.second->y_pos);
+      paint_pixel(theCell, nearPixel.second.x_pos, nearPixel.second.y_pos);
       // cout << " near found!! " << endl;
     }
     else
-      paint_pixel(theCell, myPixel.second->x_pos, myPixel.second->y_pos);
+      paint_pixel(theCell, myPixel.second.x_pos, myPixel.second.y_pos);
     return true;
   }
   else {
 #ifdef DEBUG
     cout << " Map move fail !!" << endl;
-    cout << " cell name : " << theCell->name << endl;
+    cout << " cell name : " << cell_name(theCell) << endl;
     cout << " init_x_coord : " << theCell->init_x_coord << endl;
     cout << " init_y_coord : " << theCell->init_y_coord << endl;
 #endif
@@ -926,24 +1064,8 @@ vector< cell* > circuit::overlap_cells(cell* theCell) {
   vector< cell* > list;
   int step_x = (int)ceil(theCell->width / wsite);
   int step_y = (int)ceil(theCell->height / rowHeight);
-
-  OPENDP_HASH_MAP< unsigned, cell* > cell_list;
-#ifdef USE_GOOGLE_HASH
-  cell_list.set_empty_key(UINT_MAX);
-#endif
-
-  for(int i = theCell->y_pos; i < theCell->y_pos + step_y; i++) {
-    for(int j = theCell->x_pos; j < theCell->y_pos + step_x; j++) {
-      if(grid[i][j].linked_cell != NULL) {
-        cell_list[grid[i][j].linked_cell->id] = grid[i][j].linked_cell;
-      }
-    }
-  }
-  list.reserve(cell_list.size());
-  for(auto& currCell : cell_list) {
-    list.push_back(currCell.second);
-  }
-
+  window_cells(theCell->x_pos, theCell->y_pos, theCell->x_pos + step_x,
+               theCell->y_pos + step_y, list);
   return list;
 }
 
@@ -960,26 +1082,38 @@ vector< cell* > circuit::get_cells_from_boundary(rect* theRect) {
   int y_end = (int)floor(theRect->yUR / rowHeight + 0.5);
 
   vector< cell* > list;
+  window_cells(x_start, y_start, x_end, y_end, list);
+  list.erase(std::remove_if(list.begin(), list.end(),
+                            [](cell* c) { return c->isFixed; }),
+             list.end());
+  return list;
+}
 
-  OPENDP_HASH_MAP< unsigned, cell* > cell_list;
-#ifdef USE_GOOGLE_HASH
-  cell_list.set_empty_key(UINT_MAX);
-#endif
-
-  for(int i = y_start; i < y_end; i++) {
-    for(int j = x_start; j < x_end; j++) {
-      if(grid[i][j].linked_cell != NULL) {
-        if(grid[i][j].linked_cell->isFixed == false)
-          cell_list[grid[i][j].linked_cell->id] = grid[i][j].linked_cell;
-      }
+// distinct cells on sites [x_begin, x_end) x [y_begin, y_end), in order of
+// first site. Empty sites are skipped on the occupancy bitmaps; a cell is
+// taken at its first row in the window and its run in the row is skipped
+void circuit::window_cells(int x_begin, int y_begin, int x_end, int y_end,
+                           vector< cell* >& list) {
+  x_begin = max(x_begin, 0);
+  y_begin = max(y_begin, 0);
+  x_end = min(x_end, grid.col_num);
+  y_end = min(y_end, grid.row_num);
+  for(int i = y_begin; i < y_end; i++) {
+    int j = (x_begin < x_end) ? grid.next_occupied(i, x_begin, x_end) : -1;
+    while(j >= 0) {
+      unsigned cellId = grid.cell_at(i, j);
+      int run_end = j + 1;
+      if(cellId != PIXEL_DUMMY && cells[cellId].isFixed == false)
+        run_end = cells[cellId].x_pos + (int)ceil(cells[cellId].width / wsite);
+      else
+        while(run_end < x_end && grid.cell_at(i, run_end) == cellId) run_end++;
+      if(cellId != PIXEL_DUMMY &&
+         (i == y_begin || grid.cell_at(i - 1, j) != cellId))
+        list.push_back(&cells[cellId]);
+      j = (run_end < x_end) ? grid.next_occupied(i, run_end, x_end) : -1;
     }
   }
-
-  list.reserve(cell_list.size());
-  for(auto& currCell : cell_list) {
-    list.push_back(currCell.second);
-  }
-  return list;
+  return;
 }
 
 double circuit::dist_benefit(cell* theCell, int x_coord, int y_coord) {
@@ -1018,18 +1152,18 @@ bool circuit::swap_cell(cell* cellA, cell* cellB) {
   return false;
 }
 
-bool circuit::refine_move(cell* theCell, string mode) {
+bool circuit::refine_move(cell* theCell, coord_mode mode) {
   int x = INT_MAX;
   int y = INT_MAX;
-  if(mode == "init_coord") {
+  if(mode == MODE_INIT_COORD) {
     x = theCell->init_x_coord;
     y = theCell->init_y_coord;
   }
-  else if(mode == "coord") {
+  else if(mode == MODE_COORD) {
     x = theCell->x_coord;
     y = theCell->y_coord;
   }
-  else if(mode == "pos") {
+  else if(mode == MODE_POS) {
     x = theCell->x_pos * wsite;
     y = theCell->y_pos * rowHeight;
   }
@@ -1041,19 +1175,19 @@ bool circuit::refine_move(cell* theCell, string mode) {
 }
 //
 bool circuit::refine_move(cell* theCell, int x_coord, int y_coord) {
-  pair< bool, pixel* > myPixel = diamond_search(theCell, x_coord, y_coord);
+  pair< bool, pixel > myPixel = diamond_search(theCell, x_coord, y_coord);
   if(myPixel.first == true) {
     double new_dist =
-        abs(theCell->init_x_coord - myPixel.second->x_pos * wsite) +
-        abs(theCell->init_y_coord - myPixel.second->y_pos * rowHeight);
+        abs(theCell->init_x_coord - myPixel.second.x_pos * wsite) +
+        abs(theCell->init_y_coord - myPixel.second.y_pos * rowHeight);
     if(new_dist / rowHeight > max_disp_const) return false;
 
-    double benefit = dist_benefit(theCell, myPixel.second->x_pos * wsite,
-                                  myPixel.second->y_pos * rowHeight);
+    double benefit = dist_benefit(theCell, myPixel.second.x_pos * wsite,
+                                  myPixel.second.y_pos * rowHeight);
     if(benefit < 0) {
       // cout << " refine benefit : " << benefit << " : " << 2001 -
       erase_pixel(theCell);
-      paint_pixel(theCell, myPixel.second->x_pos, myPixel.second->y_pos);
+      paint_pixel(theCell, myPixel.second.x_pos, myPixel.second.y_pos);
       // save_score();
       return true;
     }
@@ -1064,25 +1198,45 @@ bool circuit::refine_move(cell* theCell, int x_coord, int y_coord) {
     return false;
 }
 
-pixel* circuit::get_pixel(int x_pos, int y_pos) {}
+pixel circuit::get_pixel(int x_pos, int y_pos) {
+  return pixel(x_pos, y_pos);
+}
+
+// occupant of grid site; NULL for empty site
+cell* circuit::pixel_cell(int y_pos, int x_pos) {
+  unsigned cellId = grid.cell_at(y_pos, x_pos);
+  if(cellId == PIXEL_EMPTY)
+    return NULL;
+  else if(cellId == PIXEL_DUMMY)
+    return &dummy_cell;
+  return &cells[cellId];
+}
 
+// placed cell whose origin is nearest to ( x_coord, y_coord ) within two
+// row heights, looked up on the sites around it
 pair< bool, cell* > circuit::nearest_cell(int x_coord, int y_coord) {
-  bool found = false;
+  int reach = 2 * (int)rowHeight;
+  int x_begin = (int)floor((x_coord - reach) / wsite);
+  int y_begin = (int)floor((y_coord - reach) / rowHeight);
+  int x_end = (int)ceil((x_coord + reach) / wsite) + 1;
+  int y_end = (int)ceil((y_coord + reach) / rowHeight) + 1;
+
+  vector< cell* > list;
+  window_cells(x_begin, y_begin, x_end, y_end, list);
+
   cell* nearest_cell = NULL;
-  double nearest_dist = 99999999999;
-  for(int i = 0; i < cells.size(); i++) {
-    cell* theCell = &cells[i];
+  double nearest_dist = reach;
+  for(int i = 0; i < list.size(); i++) {
+    cell* theCell = list[i];
     if(theCell->isPlaced == false) continue;
-
     double dist =
         abs(theCell->x_coord - x_coord) + abs(theCell->y_coord - y_coord);
-
-    if(dist < rowHeight * 2)
-      if(nearest_dist > dist) {
-        nearest_dist = dist;
-        nearest_cell = theCell;
-        found = true;
-      }
+    if(dist < nearest_dist ||
+       (dist == nearest_dist && nearest_cell != NULL &&
+        theCell->id < nearest_cell->id)) {
+      nearest_dist = dist;
+      nearest_cell = theCell;
+    }
   }
-  return make_pair(found, nearest_cell);
+  return make_pair(nearest_cell != NULL, nearest_cell);
 }